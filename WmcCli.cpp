@@ -13,6 +13,9 @@
 #include "fsmlist.hpp"
 #include <EEPROM.h>
 #include <stdio.h>
+#if APP_CFG_UC == APP_CFG_UC_ESP8266
+#include <ESP8266WiFi.h>
+#endif
 
 /***********************************************************************************************************************
    D A T A   D E C L A R A T I O N S (exported, local)
@@ -30,6 +33,38 @@ const char* WmcCli::Ac           = "ac";
 const char* WmcCli::Dump         = "dump";
 const char* WmcCli::Settings     = "settings";
 const char* WmcCli::Reset        = "reset";
+const char* WmcCli::Get          = "get";
+const char* WmcCli::Set          = "set ";
+const char* WmcCli::Baud         = "baud";
+const char* WmcCli::Flow         = "flow";
+const char* WmcCli::Verify       = "verify";
+
+const char* WmcCli::NamePoolCharacters  = " 0123456789ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz";
+const char* WmcCli::NamePoolPunctuation = "-./()&'+!#,:;_@*\"$%<=>?[\\]^`{|}~";
+#if WMC_CLI_MODULE_MACRO == 1
+const char* WmcCli::Macro = "macro ";
+#endif
+#if WMC_CLI_MODULE_IMPORT == 1
+const char* WmcCli::Import = "import";
+#endif
+#if WMC_CLI_MODULE_PROFILE == 1
+const char* WmcCli::Profile = "profile ";
+#endif
+#if WMC_CLI_MODULE_UNDO == 1
+const char* WmcCli::Undo    = "undo";
+const char* WmcCli::History = "history";
+#endif
+#if WMC_CLI_MODULE_SYNC == 1
+const char* WmcCli::Sync = "sync";
+#endif
+#if WMC_CLI_MODULE_DIAGNOSTICS == 1
+const char* WmcCli::Checksum = "checksum";
+const char* WmcCli::Bench    = "bench";
+const char* WmcCli::Eep      = "eep ";
+#endif
+#if WMC_CLI_MODULE_TRACE == 1
+const char* WmcCli::TraceCmd = "trace ";
+#endif
 #if APP_CFG_UC == APP_CFG_UC_ESP8266
 const char* WmcCli::Ssid          = "ssid ";
 const char* WmcCli::Password      = "password ";
@@ -39,9 +74,29 @@ const char* WmcCli::Gateway       = "gateway";
 const char* WmcCli::Subnet        = "subnet";
 const char* WmcCli::Network       = "network";
 const char* WmcCli::AdcInvalidate = "adc";
-const char* WmcCli::Buttons       = "buttons";
+const char* WmcCli::Calibrate     = "calibrate";
 const char* WmcCli::StaticIp      = "static";
+#if WMC_CLI_MODULE_DIAGNOSTICS == 1
+const char* WmcCli::Buttons = "buttons";
+#endif
+#endif
+
+const settingDescriptor WmcCli::SettingsTable[] = {
+    { "ac", EepCfg::AcTypeControlAddress, settingTypeOption, 1, WmcCli::cliChangeAc, 0 },
+    { "emergency", EepCfg::EmergencyStopEnabledAddress, settingTypeOption, 1, WmcCli::cliChangeEmergency, 0 },
+#if APP_CFG_UC == APP_CFG_UC_ESP8266
+    { "ssid", EepCfg::SsidNameAddress, settingTypeString, 40, WmcCli::cliChangeNetwork, WmcCli::networkChangeWifi },
+    { "password", EepCfg::SsidPasswordAddress, settingTypeString, 64, WmcCli::cliChangeNetwork,
+        WmcCli::networkChangeWifi },
+    { "z21", EepCfg::EepIpAddressZ21, settingTypeIp, 4, WmcCli::cliChangeNetwork, WmcCli::networkChangeZ21 },
+    { "static", EepCfg::StaticIpAddress, settingTypeOption, 1, WmcCli::cliChangeNetwork, WmcCli::networkChangeIp },
+    { "ip", EepCfg::EepIpAddressWmc, settingTypeIp, 4, WmcCli::cliChangeNetwork, WmcCli::networkChangeIp },
+    { "gateway", EepCfg::EepIpGateway, settingTypeIp, 4, WmcCli::cliChangeNetwork, WmcCli::networkChangeIp },
+    { "subnet", EepCfg::EepIpSubnet, settingTypeIp, 4, WmcCli::cliChangeNetwork, WmcCli::networkChangeIp },
 #endif
+};
+
+const uint8_t WmcCli::SettingsTableSize = sizeof(WmcCli::SettingsTable) / sizeof(WmcCli::SettingsTable[0]);
 
 /***********************************************************************************************************************
    F U N C T I O N S
@@ -51,20 +106,109 @@ const char* WmcCli::StaticIp      = "static";
  */
 WmcCli::WmcCli()
 {
-    m_bufferRxIndex = 0;
-    m_Address       = 0;
-    m_DecoderSteps  = 0;
-    m_Function      = 0;
-    m_Button        = 0;
+    m_bufferRxIndex        = 0;
+    m_Address              = 0;
+    m_DecoderSteps         = 0;
+    m_Function             = 0;
+    m_Button               = 0;
+    m_Change               = cliChangeNone;
+    m_ChangePending        = cliChangeNone;
+    m_ChangeSeal           = cliChangeNone;
+    m_ChangeLoc            = 0;
+    m_ChangeLocPending     = 0;
+    m_RosterGeneration     = 0;
+    m_RxTime               = 0;
+    m_CommandTime          = 0;
+    m_RosterChecksum       = 0;
+    m_SettingsChecksum     = 0;
+    m_ChecksumNumberOfLocs = 0;
+    m_RegionCorrupt        = 0;
+    m_CliEepValid          = false;
+#if WMC_CLI_MODULE_UNDO == 1
+    m_UndoGroupSize = 0;
+#endif
+#if WMC_CLI_MODULE_TRACE == 1
+    m_TraceIndex           = 0;
+    m_TraceNumberOfEntries = 0;
+#endif
+#if WMC_CLI_LOC_INDEX_SIZE > 0
+    m_LocIndexNumberOfLocs = 0;
+    m_LocIndexValid        = false;
+#endif
+    m_BaudRate       = BaudRateDefault;
+    m_BaudSwitchTime = 0;
+    m_BaudPending    = false;
+    m_FlowControl    = flowNone;
+    m_FlowStopped    = false;
+    m_RxOverflow     = false;
+#if WMC_CLI_MODULE_MACRO == 1
+    m_MacroRecording = false;
+#endif
+#if WMC_CLI_MODULE_IMPORT == 1
+    m_ImportActive = false;
+    m_ImportState  = importText;
+#endif
+#if APP_CFG_UC == APP_CFG_UC_ESP8266
+    m_NetworkChange           = networkChangeNone;
+    m_NetworkChangeApplied    = networkChangeNone;
+    m_NetworkChangeTime       = 0;
+    m_NetworkReconnectPending = false;
+    m_NetworkDown             = false;
+    m_CalibrateStep           = 0;
+#endif
+    memset(m_bufferRx, '\0', sizeof(m_bufferRx));
 }
 
 /***********************************************************************************************************************
  */
 void WmcCli::Init(LocLib LocLib, LocStorage LocStorage)
 {
-    Serial.begin(115200);
+    uint8_t Region;
+#if WMC_CLI_MODULE_UNDO == 1
+    uint8_t Head;
+    uint8_t Count;
+#endif
+
+#if APP_CFG_UC == APP_CFG_UC_ESP8266
+    Serial.setRxBufferSize(WMC_CLI_RX_BUFFER_SIZE);
+#endif
+    Serial.begin(m_BaudRate);
+#ifdef WMC_CLI_RTS_PIN
+    pinMode(WMC_CLI_RTS_PIN, OUTPUT);
+    digitalWrite(WMC_CLI_RTS_PIN, LOW);
+#endif
     m_locLib     = LocLib;
     m_LocStorage = LocStorage;
+
+    RosterChecksumCalculate();
+
+    /* The EEPROM size of the target may be smaller than WMC_CLI_EEP_SIZE. */
+    m_CliEepValid = (CliEepEnd <= EEPROM.length());
+    if (m_CliEepValid == false)
+    {
+        Serial.println("Cli EEPROM area too large, macros, profiles, undo, long names and verify disabled.");
+
+        /* Without checksums only the range check remains, the cached values are used unchecked later on. */
+        for (Region = regionRoster; Region < regionCount; Region++)
+        {
+            if (RegionValid(Region) == false)
+            {
+                RegionRepair(Region);
+            }
+        }
+    }
+    else
+    {
+        IntegrityCheck(false, false);
+
+#if WMC_CLI_MODULE_UNDO == 1
+        if (UndoHeaderGet(&Head, &Count) == false)
+        {
+            EepCommit();
+        }
+#endif
+    }
+    SettingsChecksumUpdate();
 }
 
 /***********************************************************************************************************************
@@ -79,113 +223,218 @@ void WmcCli::Update(void)
 
     while (DataRx != -1)
     {
-        Serial.print((char)(DataRx));
-        switch (DataRx)
-        {
-        case 0x0A: break;
-        case 0x0D:
-            Process();
-            m_bufferRxIndex = 0;
-            memset(m_bufferRx, '\0', sizeof(m_bufferRx));
-            break;
-        default:
-            m_bufferRx[m_bufferRxIndex] = (char)(DataRx);
-            m_bufferRxIndex++;
+        m_RxTime = millis();
 
-            if (m_bufferRxIndex >= sizeof(m_bufferRx))
+#if WMC_CLI_MODULE_IMPORT == 1
+        if (m_ImportActive == true)
+        {
+            /* Import data is not echoed and not stored as command, the stored locs hold the change event back. */
+            ImportChar((char)(DataRx));
+            m_CommandTime = m_RxTime;
+        }
+        else
+#endif
+        {
+            Serial.print((char)(DataRx));
+            switch (DataRx)
             {
+            case 0x0A: break;
+            case 0x0D:
+                FlowStop();
+                if (m_RxOverflow == true)
+                {
+                    /* Never execute the start of a too long command. */
+                    m_RxOverflow = false;
+                    Serial.println("Command too long, ignored.");
+                }
+                else
+                {
+                    Trace(traceCommandStart, ((uint16_t)(m_bufferRx[0]) << 8) | (uint8_t)(m_bufferRx[1]));
+#if WMC_CLI_MODULE_UNDO == 1
+                    m_UndoGroupSize = 0;
+#endif
+                    Process();
+                    Trace(traceCommandEnd, 0);
+                }
+                m_CommandTime   = millis();
                 m_bufferRxIndex = 0;
                 memset(m_bufferRx, '\0', sizeof(m_bufferRx));
+                break;
+            default:
+                /* Keep the terminating zero, the rest of a too long command is dropped until CR. */
+                if (m_bufferRxIndex < (sizeof(m_bufferRx) - 1))
+                {
+                    m_bufferRx[m_bufferRxIndex] = (char)(DataRx);
+                    m_bufferRxIndex++;
+                }
+                else if (m_RxOverflow == false)
+                {
+                    m_RxOverflow = true;
+                    Trace(traceRxOverflow, m_bufferRxIndex);
+                }
+                break;
             }
-            break;
         }
 
         DataRx = Serial.read();
     }
+
+#if WMC_CLI_MODULE_IMPORT == 1
+    if ((m_ImportActive == true) && ((millis() - m_RxTime) > ImportTimeout))
+    {
+        ImportEnd();
+    }
+#endif
+
+    BaudUpdate();
+
+#if APP_CFG_UC == APP_CFG_UC_ESP8266
+    NetworkChangeUpdate();
+#endif
+    ChangeEventUpdate();
+
+    /* Seal the regions changed by the cli right away, the event may be held back while a reset loses the seal. */
+    if (m_ChangeSeal != cliChangeNone)
+    {
+        FlowStop();
+        ChangeSeal(m_ChangeSeal);
+        m_ChangeSeal = cliChangeNone;
+    }
+
+    FlowStart();
 }
 
 /***********************************************************************************************************************
+ * Only timers started by the cli itself are deadlines, a partly received command waits for data and is no deadline.
  */
-void WmcCli::Process(void)
+uint32_t WmcCli::NextDeadlineGet(void)
 {
-    if (strncmp(m_bufferRx, Help, strlen(Help)) == 0)
+    uint32_t Deadline = NoDeadline;
+
+    if (Serial.available() > 0)
     {
-        HelpScreen();
+        Deadline = 0;
     }
-    else if (strncmp(m_bufferRx, LocAdd, strlen(LocAdd)) == 0)
+    else
     {
-        if (Add() == true)
+        if (m_ChangePending != cliChangeNone)
+        {
+            DeadlineUpdate(&Deadline, m_CommandTime, ChangeEventDelay);
+        }
+#if WMC_CLI_MODULE_IMPORT == 1
+        if (m_ImportActive == true)
+        {
+            DeadlineUpdate(&Deadline, m_RxTime, ImportTimeout + 1);
+        }
+#endif
+        if (m_BaudPending == true)
+        {
+            DeadlineUpdate(&Deadline, m_BaudSwitchTime, BaudConfirmTimeout + 1);
+        }
+#if APP_CFG_UC == APP_CFG_UC_ESP8266
+        if (m_NetworkChange != networkChangeNone)
+        {
+            DeadlineUpdate(&Deadline, m_NetworkChangeTime, NetworkApplyDelay);
+        }
+        if (m_NetworkReconnectPending == true)
         {
-            send_event(Event);
+            /* The reconnect is detected by polling the Wifi state. */
+            DeadlineUpdate(&Deadline, millis(), NetworkPollInterval);
         }
+#endif
     }
-    else if (strncmp(m_bufferRx, LocDelete, strlen(LocDelete)) == 0)
+
+    return (Deadline);
+}
+
+/***********************************************************************************************************************
+ */
+void WmcCli::DeadlineUpdate(uint32_t* DeadlinePtr, uint32_t StartTime, uint32_t Delay)
+{
+    uint32_t Elapsed   = millis() - StartTime;
+    uint32_t Remaining = (Elapsed >= Delay) ? 0 : Delay - Elapsed;
+
+    if (Remaining < *DeadlinePtr)
+    {
+        *DeadlinePtr = Remaining;
+    }
+}
+
+/***********************************************************************************************************************
+ */
+void WmcCli::Process(void)
+{
+#if APP_CFG_UC == APP_CFG_UC_ESP8266
+    if (m_CalibrateStep != 0)
+    {
+        CalibrateStep();
+    }
+    else
+#endif
+#if WMC_CLI_MODULE_MACRO == 1
+        if (strncmp(m_bufferRx, Macro, strlen(Macro)) == 0)
     {
-        if (Delete() == true)
+        if (CliEepAvailable() == true)
         {
-            send_event(Event);
+            MacroCommand();
         }
     }
+    else if (m_MacroRecording == true)
+    {
+        MacroRecordLine();
+    }
+    else
+#endif
+        if (strncmp(m_bufferRx, Help, strlen(Help)) == 0)
+    {
+        HelpScreen();
+    }
+    else if (strncmp(m_bufferRx, LocAdd, strlen(LocAdd)) == 0)
+    {
+        Add();
+    }
+    else if (strncmp(m_bufferRx, LocDelete, strlen(LocDelete)) == 0)
+    {
+        Delete();
+    }
     else if (strncmp(m_bufferRx, LocDeleteAll, strlen(LocDeleteAll)) == 0)
     {
+        UndoRecord(undoOpClear, 0, NULL);
         m_locLib.InitialLocStore();
+        LocIndexInvalidate();
+        RosterChecksumCalculate();
+        ChangeSet(cliChangeRoster);
         Serial.println("All locs cleared.");
-        send_event(Event);
     }
     else if (strncmp(m_bufferRx, EraseAll, strlen(EraseAll)) == 0)
     {
-        m_locLib.InitialLocStore();
-        m_LocStorage.AcOptionSet(0);
-        m_LocStorage.EmergencyOptionSet(0);
-
-#if APP_CFG_UC == APP_CFG_UC_ESP8266
-        IpSettingsDefault();
-#elif APP_CFG_UC == APP_CFG_UC_STM32
-        m_LocStorage.XpNetAddressSet(255);
-#endif
-
-        Serial.println("All data cleared.");
-        send_event(Event);
+        EraseAllData();
     }
     else if (strncmp(m_bufferRx, Emergency, strlen(Emergency)) == 0)
     {
-        if (EmergencyChange())
-        {
-            send_event(Event);
-        }
+        EmergencyChange();
     }
     else if (strncmp(m_bufferRx, LocChange, strlen(LocChange)) == 0)
     {
-        if (Change() == true)
-        {
-            send_event(Event);
-        }
+        Change();
     }
     else if (strncmp(m_bufferRx, LocName, strlen(LocName)) == 0)
     {
-        if (SetName() == true)
-        {
-            send_event(Event);
-        }
+        SetName();
     }
 
 #if APP_CFG_UC == APP_CFG_UC_ESP8266
     else if (strncmp(m_bufferRx, Ssid, strlen(Ssid)) == 0)
     {
-        SsIdWriteName();
-        send_event(Event);
+        SettingApply("ssid", &m_bufferRx[strlen(Ssid)]);
     }
     else if (strncmp(m_bufferRx, Password, strlen(Password)) == 0)
     {
-        SsIdWritePassword();
-        send_event(Event);
+        SettingApply("password", &m_bufferRx[strlen(Password)]);
     }
     else if (strncmp(m_bufferRx, IpAdrressZ21, strlen(IpAdrressZ21)) == 0)
     {
-        if (IpAddressWriteZ21() == true)
-        {
-            send_event(Event);
-        }
+        SettingApply(IpAdrressZ21, &m_bufferRx[strlen(IpAdrressZ21)]);
     }
     else if (strncmp(m_bufferRx, Network, strlen(Network)) == 0)
     {
@@ -200,16 +449,103 @@ void WmcCli::Process(void)
     {
         DumpData();
     }
+#if WMC_CLI_MODULE_DIAGNOSTICS == 1
+    else if (strncmp(m_bufferRx, Checksum, strlen(Checksum)) == 0)
+    {
+        ChecksumCommand();
+    }
+    else if (strncmp(m_bufferRx, Bench, strlen(Bench)) == 0)
+    {
+        if (CliEepAvailable() == true)
+        {
+            BenchCommand();
+        }
+    }
+    else if (strncmp(m_bufferRx, Eep, strlen(Eep)) == 0)
+    {
+        EepCommand();
+    }
+#endif
+#if WMC_CLI_MODULE_TRACE == 1
+    else if (strncmp(m_bufferRx, TraceCmd, strlen(TraceCmd)) == 0)
+    {
+        TraceCommand();
+    }
+#endif
+    else if (strncmp(m_bufferRx, Verify, strlen(Verify)) == 0)
+    {
+        if (CliEepAvailable() == true)
+        {
+            IntegrityCheck(true, strncmp(&m_bufferRx[strlen(Verify)], " repair", 7) == 0);
+        }
+    }
+#if WMC_CLI_MODULE_SYNC == 1
+    else if (strncmp(m_bufferRx, Sync, strlen(Sync)) == 0)
+    {
+        SyncCommand();
+    }
+#endif
+#if WMC_CLI_MODULE_IMPORT == 1
+    else if (strncmp(m_bufferRx, Import, strlen(Import)) == 0)
+    {
+        memset(m_Scratch.Import.Tag, '\0', sizeof(m_Scratch.Import.Tag));
+        m_ImportActive           = true;
+        m_ImportState            = importText;
+        m_ImportAddress          = 0;
+        m_ImportNumberOfLocs     = 0;
+        m_ImportNumberOfFailures = 0;
+        m_ImportStartTime        = millis();
+        Serial.println("Send JMRI roster (roster.xml or loc file), import ends with the end of the file or ESC.");
+    }
+#endif
+#if WMC_CLI_MODULE_UNDO == 1
+    else if (strncmp(m_bufferRx, Undo, strlen(Undo)) == 0)
+    {
+        if (CliEepAvailable() == true)
+        {
+            UndoCommand();
+        }
+    }
+    else if (strncmp(m_bufferRx, History, strlen(History)) == 0)
+    {
+        if (CliEepAvailable() == true)
+        {
+            UndoHistory();
+        }
+    }
+#endif
+#if WMC_CLI_MODULE_PROFILE == 1
+    else if (strncmp(m_bufferRx, Profile, strlen(Profile)) == 0)
+    {
+        if (CliEepAvailable() == true)
+        {
+            ProfileCommand();
+        }
+    }
+#endif
+    else if (strncmp(m_bufferRx, Baud, strlen(Baud)) == 0)
+    {
+        BaudCommand();
+    }
+    else if (strncmp(m_bufferRx, Flow, strlen(Flow)) == 0)
+    {
+        FlowCommand();
+    }
+    else if (strncmp(m_bufferRx, Get, strlen(Get)) == 0)
+    {
+        SettingsGet();
+    }
+    else if (strncmp(m_bufferRx, Set, strlen(Set)) == 0)
+    {
+        SettingsSet();
+    }
     else if (strncmp(m_bufferRx, Settings, strlen(Settings)) == 0)
     {
         ShowSettings();
     }
     else if (strncmp(m_bufferRx, Ac, strlen(Ac)) == 0)
     {
-        if (AcControlType() == true)
-        {
-            send_event(Event);
-        }
+        AcControlType();
     }
 #if APP_CFG_UC == APP_CFG_UC_STM32
     else if (strncmp(m_bufferRx, Reset, strlen(Reset)) == 0)
@@ -220,65 +556,166 @@ void WmcCli::Process(void)
 #if APP_CFG_UC == APP_CFG_UC_ESP8266
     else if (strncmp(m_bufferRx, StaticIp, strlen(StaticIp)) == 0)
     {
-        if (StaticIpChange() == true)
-        {
-            send_event(Event);
-        }
+        SettingApply(StaticIp, &m_bufferRx[strlen(StaticIp)]);
     }
     else if (strncmp(m_bufferRx, Ip, strlen(Ip)) == 0)
     {
-        if (IpAddressWriteWmc() == true)
-        {
-            send_event(Event);
-        }
+        SettingApply(Ip, &m_bufferRx[strlen(Ip)]);
     }
     else if (strncmp(m_bufferRx, Gateway, strlen(Gateway)) == 0)
     {
-        if (IpAddressWriteGateway() == true)
-        {
-            send_event(Event);
-        }
+        SettingApply(Gateway, &m_bufferRx[strlen(Gateway)]);
     }
     else if (strncmp(m_bufferRx, Subnet, strlen(Subnet)) == 0)
     {
-        if (IpAddressWriteSubnet() == true)
-        {
-            send_event(Event);
-        }
+        SettingApply(Subnet, &m_bufferRx[strlen(Subnet)]);
     }
     else if (strncmp(m_bufferRx, AdcInvalidate, strlen(AdcInvalidate)) == 0)
     {
         m_LocStorage.InvalidateAdc();
+        SettingsChecksumUpdate();
+        ChangeSet(cliChangeAdc);
         Serial.println("ADC values for button invalidated.");
-        send_event(Event);
     }
+    else if (strncmp(m_bufferRx, Calibrate, strlen(Calibrate)) == 0)
+    {
+        m_CalibrateStep = 1;
+        Serial.println("Button calibration, enter abort to stop.");
+        CalibratePrompt();
+    }
+#if WMC_CLI_MODULE_DIAGNOSTICS == 1
     else if (strncmp(m_bufferRx, Buttons, strlen(Buttons)) == 0)
     {
         PrintButtonAdcData();
     }
 #endif
-    else
+#endif
+    else if (m_bufferRx[0] != '\0')
     {
         Serial.println("Unknown command.");
     }
 }
 
+/***********************************************************************************************************************
+ */
+uint8_t WmcCli::ChangeGet(void)
+{
+    return (m_Change);
+}
+
+/***********************************************************************************************************************
+ */
+uint16_t WmcCli::ChangeLocGet(void)
+{
+    return (m_ChangeLoc);
+}
+
+/***********************************************************************************************************************
+ */
+void WmcCli::ChangeSet(uint8_t Change, uint16_t Address)
+{
+    if ((Change & cliChangeLoc) != 0)
+    {
+        if (((m_ChangePending & cliChangeLoc) != 0) && (m_ChangeLocPending != Address))
+        {
+            /* Several locs changed, let the application reload all locs. */
+            Change = (Change & ~cliChangeLoc) | cliChangeRoster;
+        }
+
+        m_ChangeLocPending = Address;
+    }
+
+    if ((Change & (cliChangeRoster | cliChangeLoc)) != 0)
+    {
+        m_RosterGeneration++;
+    }
+
+    m_ChangePending |= Change;
+    m_ChangeSeal |= Change;
+}
+
+/***********************************************************************************************************************
+ */
+uint16_t WmcCli::RosterGenerationGet(void)
+{
+    return (m_RosterGeneration);
+}
+
+/***********************************************************************************************************************
+ * Changes are collected until no command is received for a short time, so a restore of many lines results in one cli
+ * event instead of an event (and reload of all data by the application) for each line. Received characters without
+ * CR do not hold the event back.
+ */
+void WmcCli::ChangeEventUpdate(void)
+{
+    if ((m_ChangePending != cliChangeNone) && ((millis() - m_CommandTime) >= ChangeEventDelay))
+    {
+        m_Change           = m_ChangePending;
+        m_ChangeLoc        = m_ChangeLocPending;
+        m_ChangePending    = cliChangeNone;
+        m_ChangeLocPending = 0;
+        FlowStop();
+        Trace(traceEvent, m_Change);
+        send_event(Event);
+    }
+}
+
 /***********************************************************************************************************************
  */
 void WmcCli::HelpScreen(void)
 {
     Serial.println("add x           : Add loc with address x.");
-    Serial.println("name x y        : Set name of loc address x with name y.");
-    Serial.println("del x           : Delete loc with address x.");
+    Serial.println("name x y        : Set name of loc address x with name y (or range x-y).");
+    Serial.println("name .. prefix z: For a range, set name of each loc to z followed by the address.");
+    Serial.println("del x           : Delete loc with address x, x-y deletes all locs from address x to y.");
     Serial.println("clear           : Delete ALL locs.");
     Serial.println("erase           : Erase ALL data.");
-    Serial.println("change x y z    : Assign function z to button y of loc with address x.");
+    Serial.println("change x y z    : Assign function z to button y of loc with address x (or range x-y).");
     Serial.println("emergency x     : Set power off (0) or emergency stop (1).");
     Serial.println("list            : Show all programmed locs.");
     Serial.println("dump            : Dump data for backup.");
+    Serial.println("verify          : Check stored data, verify repair restores corrupt data.");
+#if WMC_CLI_MODULE_DIAGNOSTICS == 1
+    Serial.println("checksum        : Show checksum of locs and settings, checksum full recalculates.");
+    Serial.println("bench           : Measure EEPROM, serial, loc table and command speed.");
+    Serial.println("eep read x n    : Show n EEPROM bytes from address x as eep write commands.");
+    Serial.println("eep write x <>  : Write hex data to address x of a settings or cli EEPROM region.");
+#endif
+#if WMC_CLI_MODULE_TRACE == 1
+    Serial.println("trace dump      : Show trace of commands, commits and events, trace clear empties it.");
+#endif
+#if WMC_CLI_MODULE_IMPORT == 1
+    Serial.println("import          : Import locs from JMRI roster XML data.");
+#endif
+#if WMC_CLI_MODULE_SYNC == 1
+    Serial.println("sync            : Show number of locs and root hash of all locs.");
+    Serial.println("sync list       : Show hash of each loc.");
+    Serial.println("sync loc <>     : Add or update loc, data: address f0 f1 f2 f3 f4 name.");
+#endif
+#if WMC_CLI_MODULE_MACRO == 1
+    Serial.println("macro record x  : Record following commands in macro x, $1..$4 as loc address.");
+    Serial.println("macro end       : Stop recording and store macro.");
+    Serial.println("macro abort     : Stop recording without storing the macro.");
+    Serial.println("macro run x a b : Run macro x, $1 is replaced by a, $2 by b etc.");
+    Serial.println("macro list      : Show stored macros.");
+    Serial.println("macro del x     : Delete macro x.");
+#endif
+#if WMC_CLI_MODULE_UNDO == 1
+    Serial.println("undo n          : Revert the last (n) commands which changed locs.");
+    Serial.println("history         : Show commands which can be reverted, last command first.");
+#endif
+#if WMC_CLI_MODULE_PROFILE == 1
+    Serial.println("profile save x  : Store all locs as profile x.");
+    Serial.println("profile load x  : Replace all locs by the locs of profile x.");
+    Serial.println("profile list    : Show stored profiles, * marks the active profile.");
+    Serial.println("profile delete x: Delete profile x.");
+#endif
 #if APP_CFG_UC == APP_CFG_UC_ESP8266
     Serial.println("adc             : Invalidate ADC button values.");
+    Serial.println("calibrate       : Measure and store ADC button values step by step.");
+#if WMC_CLI_MODULE_DIAGNOSTICS == 1
     Serial.println("buttons         : Show ADC value for each button.");
+#endif
     Serial.println("ssid <>         : Set SSID name (Wifi) to connect to.");
     Serial.println("password <>     : Set password (Wifi).");
     Serial.println("z21 a.b.c.d     : Set IP address of Z21 control.");
@@ -289,6 +726,10 @@ void WmcCli::HelpScreen(void)
 #endif
     Serial.println("ac x            : Enable (x=1) / disable (x=0) AC control option.");
     Serial.println("settings        : Show overview of settings.");
+    Serial.println("baud x          : Switch to baud rate x, confirm with baud ok at the new baud rate.");
+    Serial.println("flow x          : Flow control while a command is executed, x is none, xon or rts.");
+    Serial.println("get x y ..      : Show value of settings x, y etc., get without key shows all settings.");
+    Serial.println("set x y         : Set value of setting x to y.");
 #if APP_CFG_UC == APP_CFG_UC_STM32
     Serial.println("reset           : Perform reset.");
 #endif
@@ -296,120 +737,198 @@ void WmcCli::HelpScreen(void)
 }
 
 /***********************************************************************************************************************
+ * All settings and the macros are written in the EEPROM buffer and committed once, instead of a commit (sector
+ * write on the ESP8266) for each setting.
  */
-#if APP_CFG_UC == APP_CFG_UC_ESP8266
-void WmcCli::SsIdWriteName(void)
-{
-    memset(m_SsidName, '\0', sizeof(m_SsidName));
-    memcpy(m_SsidName, &m_bufferRx[strlen(Ssid)], strlen(&m_bufferRx[strlen(Ssid)]));
-    EEPROM.put(EepCfg::SsidNameAddress, m_SsidName);
-    EEPROM.commit();
-
-    Serial.print("SSID name : ");
-    Serial.print(m_SsidName);
-    Serial.println(" stored.");
-}
-
-/***********************************************************************************************************************
- */
-void WmcCli::SsIdWritePassword(void)
+void WmcCli::EraseAllData(void)
 {
-    memset(m_SsidPassword, '\0', sizeof(m_SsidPassword));
-    memcpy(m_SsidPassword, &m_bufferRx[strlen(Password)], strlen(&m_bufferRx[strlen(Password)]));
-    EEPROM.put(EepCfg::SsidPasswordAddress, m_SsidPassword);
-    EEPROM.commit();
+    uint8_t Slot;
+    uint32_t StartTime = millis();
+    uint32_t StepTime  = StartTime;
 
-    Serial.print("SSID password : ");
-    Serial.print(m_SsidPassword);
-    Serial.println(" stored.");
-}
+    Serial.print("Erase locs     : ");
+    m_locLib.InitialLocStore();
+    LocIndexInvalidate();
+    RosterChecksumCalculate();
+    Serial.print(millis() - StepTime);
+    Serial.println(" ms");
 
+    Serial.print("Erase settings : ");
+    StepTime = millis();
+    m_LocStorage.AcOptionSet(0);
+    m_LocStorage.EmergencyOptionSet(0);
+    if (m_CliEepValid == true)
+    {
+        for (Slot = 0; Slot < MacroSlots; Slot++)
+        {
+            EEPROM.write(MacroEepAddress + (Slot * MacroSlotSize), 0);
+        }
+        NamePoolUsedSet(0);
+#if WMC_CLI_MODULE_UNDO == 1
+        UndoClear();
+#endif
+#if WMC_CLI_MODULE_PROFILE == 1
+        EEPROM.write(ProfileEepAddress, 255);
+        for (Slot = 0; Slot < WMC_CLI_PROFILE_SLOTS; Slot++)
+        {
+            EEPROM.write(ProfileEepAddress + 1 + (Slot * ProfileSlotSize), 0);
+        }
+#endif
+    }
+
+#if APP_CFG_UC == APP_CFG_UC_ESP8266
+    /* Writes the network defaults and commits all settings. */
+    IpSettingsDefault();
+    m_NetworkChangeApplied = networkChangeZ21 | networkChangeIp | networkChangeWifi;
+    ChangeSet(cliChangeNetwork | cliChangeAdc);
+#elif APP_CFG_UC == APP_CFG_UC_STM32
+    m_LocStorage.XpNetAddressSet(255);
+    ChangeSet(cliChangeXpNet);
+#endif
+    ChangeSet(cliChangeRoster | cliChangeAc | cliChangeEmergency);
+    SettingsChecksumUpdate();
+    Serial.print(millis() - StepTime);
+    Serial.println(" ms");
+
+    Serial.print("All data cleared in ");
+    Serial.print(millis() - StartTime);
+    Serial.println(" ms.");
+}
+
+#if APP_CFG_UC == APP_CFG_UC_ESP8266
 /***********************************************************************************************************************
+ * The receive buffer is checked once by NextDeadlineGet(), then one delay() yields to the SDK, which may sleep when
+ * nothing else is pending. Data received meanwhile stays in the receive buffer, so the wait ends before half of it
+ * can be filled at the actual baud rate.
  */
-bool WmcCli::IpAddressWriteZ21(void)
+void WmcCli::IdleWait(uint32_t MaxTime)
 {
-    bool Result = true;
+    uint32_t Deadline = NextDeadlineGet();
+    uint32_t RxTime   = ((uint32_t)(WMC_CLI_RX_BUFFER_SIZE / 2) * 10000UL) / m_BaudRate;
 
-    if (IpGetData(IpAdrressZ21, m_IpAddressZ21) == true)
+    if (Deadline < MaxTime)
     {
-        EEPROM.put(EepCfg::EepIpAddressZ21, m_IpAddressZ21);
-        EEPROM.commit();
-
-        Serial.print("IP Address Z21 stored : ");
-        Serial.print(m_IpAddressZ21[0]);
-        Serial.print(".");
-        Serial.print(m_IpAddressZ21[1]);
-        Serial.print(".");
-        Serial.print(m_IpAddressZ21[2]);
-        Serial.print(".");
-        Serial.println(m_IpAddressZ21[3]);
+        MaxTime = Deadline;
     }
-    else
+    if (RxTime < MaxTime)
     {
-        Result = false;
-        Serial.println("IP Address Z21 entry invalid!");
+        MaxTime = RxTime;
     }
 
-    return (Result);
+    if (MaxTime > 0)
+    {
+        delay(MaxTime);
+    }
 }
 
 /***********************************************************************************************************************
  */
 void WmcCli::ShowNetworkSettings(void)
 {
-    uint8_t Static;
-    memset(m_IpSubnet, 0, sizeof(m_IpSubnet));
-    memset(m_IpGateway, 0, sizeof(m_IpGateway));
-    memset(m_IpAddressZ21, 0, sizeof(IpAdrressZ21));
-    memset(m_IpAddresWmc, 0, sizeof(m_IpAddresWmc));
-    memset(m_SsidName, '\0', sizeof(m_SsidName));
-    memset(m_SsidPassword, '\0', sizeof(m_SsidPassword));
+    uint8_t Index;
 
-    /* Get and print the network settings. */
-    EEPROM.get(EepCfg::SsidNameAddress, m_SsidName);
-    Serial.print(Ssid);
-    Serial.println(m_SsidName);
+    /* Print the network settings in command format. */
+    for (Index = 0; Index < SettingsTableSize; Index++)
+    {
+        if (SettingsTable[Index].Change != networkChangeNone)
+        {
+            SettingPrint(Index);
+        }
+    }
+}
 
-    EEPROM.get(EepCfg::SsidPasswordAddress, m_SsidPassword);
-    Serial.print(Password);
-    Serial.println(m_SsidPassword);
+/***********************************************************************************************************************
+ */
+uint8_t WmcCli::NetworkChangeGet(void)
+{
+    return (m_NetworkChangeApplied);
+}
 
-    EEPROM.get(EepCfg::EepIpAddressZ21, m_IpAddressZ21);
-    IpDataPrint(IpAdrressZ21, m_IpAddressZ21);
+/***********************************************************************************************************************
+ */
+void WmcCli::NetworkChangeSet(uint8_t Change)
+{
+    m_NetworkChange |= Change;
+    m_NetworkChangeTime = millis();
+}
 
-    EEPROM.get(EepCfg::EepIpAddressWmc, m_IpAddresWmc);
-    IpDataPrint(Ip, m_IpAddresWmc);
+/***********************************************************************************************************************
+ * Network changes are collected until no command is received for a short time, so a pasted block of network
+ * settings results in one restart of the network. When the Wifi or IP settings are changed the time until the Wifi
+ * connection is up again is measured.
+ */
+void WmcCli::NetworkChangeUpdate(void)
+{
+    if ((m_NetworkChange != networkChangeNone) && ((millis() - m_NetworkChangeTime) >= NetworkApplyDelay))
+    {
+        m_NetworkChangeApplied = m_NetworkChange;
+        m_NetworkChange        = networkChangeNone;
 
-    EEPROM.get(EepCfg::EepIpGateway, m_IpGateway);
-    IpDataPrint(Gateway, m_IpGateway);
+        if ((m_NetworkChangeApplied & (networkChangeWifi | networkChangeIp)) != 0)
+        {
+            m_NetworkReconnectPending = true;
+            m_NetworkDown             = false;
+            Serial.println("Network settings applied, reconnecting.");
+        }
+        else
+        {
+            Serial.println("Z21 address applied, Wifi connection kept.");
+        }
 
-    EEPROM.get(EepCfg::EepIpSubnet, m_IpSubnet);
-    IpDataPrint(Subnet, m_IpSubnet);
+        m_NetworkChangeTime = millis();
+        ChangeSet(cliChangeNetwork);
+    }
+    else if (m_NetworkReconnectPending == true)
+    {
+        if (WiFi.status() != WL_CONNECTED)
+        {
+            m_NetworkDown = true;
+        }
+        else if (m_NetworkDown == true)
+        {
+            m_NetworkReconnectPending = false;
+            Serial.print("Network reconnected in ");
+            Serial.print(millis() - m_NetworkChangeTime);
+            Serial.println(" ms.");
+        }
 
-    Static = EEPROM.read(EepCfg::StaticIpAddress);
-    Serial.print(StaticIp);
-    Serial.print(" ");
-    Serial.println(Static);
+        if ((m_NetworkReconnectPending == true) && ((millis() - m_NetworkChangeTime) > NetworkReconnectLimit))
+        {
+            m_NetworkReconnectPending = false;
+            Serial.println("Network reconnect not detected.");
+        }
+    }
 }
 #endif
 
 /***********************************************************************************************************************
  */
 bool WmcCli::Add(void)
+{
+    m_Address = atoi(&m_bufferRx[strlen(LocAdd)]);
+
+    return (AddExecute(m_Address));
+}
+
+/***********************************************************************************************************************
+ */
+bool WmcCli::AddExecute(uint16_t Address)
 {
     uint8_t Functions[5] = { 0, 1, 2, 3, 4 };
     bool Result          = false;
 
-    m_Address = atoi(&m_bufferRx[strlen(LocAdd)]);
-
-    if ((m_Address > 0) && (m_Address <= 9999))
+    if ((Address > 0) && (Address <= 9999))
     {
         /* Add loc, default functions 0..4 */
-        if (m_locLib.StoreLoc(m_Address, Functions, NULL, LocLib::storeAdd) == true)
+        if (m_locLib.StoreLoc(Address, Functions, NULL, LocLib::storeAdd) == true)
         {
+            UndoRecord(undoOpAdd, Address, NULL);
             m_locLib.LocBubbleSort();
+            LocIndexInsert(Address);
+            LocChecksumToggle(Address);
+            ChangeSet(cliChangeRoster);
             Serial.print("Loc with address ");
-            Serial.print(m_Address);
+            Serial.print(Address);
             Serial.println(" added.");
             Result = true;
         }
@@ -430,18 +949,49 @@ bool WmcCli::Add(void)
  */
 bool WmcCli::Delete(void)
 {
-    m_Address   = atoi(&m_bufferRx[strlen(LocDelete)]);
-    bool Result = false;
+    uint16_t Last;
+    bool Result;
+
+    m_Address = atoi(&m_bufferRx[strlen(LocDelete)]);
+
+    if (RangeGet(&m_bufferRx[strlen(LocDelete)], &Last) == true)
+    {
+        Result = DeleteRange(m_Address, Last);
+    }
+    else
+    {
+        Result = DeleteExecute(m_Address);
+    }
+
+    return (Result);
+}
+
+/***********************************************************************************************************************
+ */
+bool WmcCli::DeleteExecute(uint16_t Address)
+{
+    uint16_t Index = LocIndexFind(Address);
+    bool Result    = false;
+
+    if (Index != LocIndexNotFound)
+    {
+        UndoRecord(undoOpDelete, Address, m_locLib.LocGetAllDataByIndex(Index));
+    }
+
+    LocChecksumToggle(Address);
 
-    if (m_locLib.RemoveLoc(m_Address) == true)
+    if (m_locLib.RemoveLoc(Address) == true)
     {
+        LocIndexRemove(Address, Index);
+        ChangeSet(cliChangeRoster);
         Serial.print("Loc ");
-        Serial.print(m_Address);
+        Serial.print(Address);
         Serial.println(" deleted.");
         Result = true;
     }
     else
     {
+        LocChecksumToggle(Address);
         Serial.println("Loc delete failed!");
     }
 
@@ -453,13 +1003,15 @@ bool WmcCli::Delete(void)
 bool WmcCli::Change(void)
 {
     char* Space;
-    uint8_t FunctionAssignment[5];
+    uint16_t Last;
+    bool Range;
     bool Result = false;
 
     Space = strchr(m_bufferRx, 32);
     Space++;
 
     m_Address = atoi(Space);
+    Range     = RangeGet(Space, &Last);
 
     Space = strchr(Space, 32);
 
@@ -474,44 +1026,74 @@ bool WmcCli::Change(void)
             Space++;
             m_Function = atoi(Space);
 
-            /* Get actual assigned functions of loc. */
-            if (m_locLib.CheckLoc(m_Address) != 255)
+            if (Range == true)
+            {
+                Result = ChangeRange(m_Address, Last, m_Button, m_Function);
+            }
+            else
+            {
+                Result = ChangeExecute(m_Address, m_Button, m_Function);
+            }
+        }
+        else
+        {
+            Serial.println("Command invalid.");
+        }
+    }
+    else
+    {
+        Serial.println("Command invalid.");
+    }
+
+    return (Result);
+}
+
+/***********************************************************************************************************************
+ */
+bool WmcCli::ChangeExecute(uint16_t Address, uint16_t Button, uint16_t Function)
+{
+    uint8_t FunctionAssignment[5];
+    uint16_t Index = LocIndexFind(Address);
+    bool Result    = false;
+
+    if (Index != LocIndexNotFound)
+    {
+        if (Button < 5)
+        {
+            if (Function < 29)
             {
-                if (m_Button < 5)
+                /* Get actual assigned functions of loc. */
+                m_locLib.FunctionAssignedGetStored(Address, FunctionAssignment);
+                FunctionAssignment[Button] = Function;
+                UndoRecord(undoOpChange, Address, m_locLib.LocGetAllDataByIndex(Index));
+                LocChecksumToggle(Address);
+                Result = m_locLib.StoreLoc(Address, FunctionAssignment, NULL, LocLib::storeChange);
+                LocChecksumToggle(Address);
+                if (Result == true)
                 {
-                    if (m_Function < 29)
-                    {
-                        m_locLib.FunctionAssignedGetStored(m_Address, FunctionAssignment);
-                        FunctionAssignment[m_Button] = m_Function;
-                        m_locLib.StoreLoc(m_Address, FunctionAssignment, NULL, LocLib::storeChange);
-                        Serial.println("Loc function updated.");
-                        Result = true;
-                    }
-                    else
-                    {
-                        Serial.println("Invalid function number, must be 0..28");
-                    }
+                    ChangeSet(cliChangeLoc, Address);
+                    Serial.println("Loc function updated.");
                 }
                 else
                 {
-                    Serial.println("Invalid button number, must be 0..4");
+                    Serial.println("Loc function update failed!");
                 }
             }
             else
             {
-                Serial.print("Loc ");
-                Serial.print(m_Address);
-                Serial.println(" is not present.");
+                Serial.println("Invalid function number, must be 0..28");
             }
         }
         else
         {
-            Serial.println("Command invalid.");
+            Serial.println("Invalid button number, must be 0..4");
         }
     }
     else
     {
-        Serial.println("Command invalid.");
+        Serial.print("Loc ");
+        Serial.print(Address);
+        Serial.println(" is not present.");
     }
 
     return (Result);
@@ -522,275 +1104,4202 @@ bool WmcCli::Change(void)
 bool WmcCli::SetName(void)
 {
     char* Space;
+    uint16_t Last;
+    bool Range;
     bool Result = false;
 
     Space = strchr(m_bufferRx, 32);
     Space++;
 
     m_Address = atoi(Space);
+    Range     = RangeGet(Space, &Last);
 
     Space = strchr(Space, 32);
 
     if (Space != NULL)
     {
         Space++;
-        /* Get data of loc. */
-        if (m_locLib.CheckLoc(m_Address) != 255)
+        if (Range == true)
+        {
+            Result = SetNameRange(m_Address, Last, Space);
+        }
+        else
+        {
+            Result = SetNameExecute(m_Address, Space);
+        }
+    }
+    else
+    {
+        Serial.println("Command invalid.");
+    }
+
+    return (Result);
+}
+
+/***********************************************************************************************************************
+ */
+bool WmcCli::SetNameExecute(uint16_t Address, const char* NamePtr)
+{
+    uint16_t Index = LocIndexFind(Address);
+    uint8_t Length;
+    bool Result = false;
+
+    /* Get data of loc. */
+    if (Index != LocIndexNotFound)
+    {
+        UndoRecord(undoOpName, Address, m_locLib.LocGetAllDataByIndex(Index));
+        LocChecksumToggle(Address);
+        Result = m_locLib.StoreLoc(Address, NULL, (char*)(NamePtr), LocLib::storeChange);
+        if (Result == true)
         {
-            m_locLib.StoreLoc(m_Address, NULL, Space, LocLib::storeChange);
+            Length = NamePoolStore(Address, NamePtr);
+            LocChecksumToggle(Address);
+            ChangeSet(cliChangeLoc, Address);
             Serial.println("Loc name updated.");
-            Result = true;
+            if (Length < strlen(NamePtr))
+            {
+                Serial.print("Name too long or name pool full, only ");
+                Serial.print(Length);
+                Serial.println(" characters stored.");
+            }
+        }
+        else
+        {
+            LocChecksumToggle(Address);
+            Serial.println("Loc name update failed!");
+        }
+    }
+    else
+    {
+        Serial.print("Loc ");
+        Serial.print(Address);
+        Serial.println(" is not present.");
+    }
+
+    return (Result);
+}
+
+/***********************************************************************************************************************
+ */
+bool WmcCli::RangeGet(const char* StrPtr, uint16_t* LastPtr)
+{
+    bool Result = false;
+
+    while (*StrPtr == ' ')
+    {
+        StrPtr++;
+    }
+
+    while ((*StrPtr >= '0') && (*StrPtr <= '9'))
+    {
+        StrPtr++;
+    }
+
+    if ((StrPtr[0] == '-') && (StrPtr[1] >= '0') && (StrPtr[1] <= '9'))
+    {
+        *LastPtr = atoi(&StrPtr[1]);
+        Result   = true;
+    }
+
+    return (Result);
+}
+
+/***********************************************************************************************************************
+ * The loc table is sorted on address, walk from the end so deleting a loc does not change the index of the locs
+ * still to be checked.
+ */
+bool WmcCli::DeleteRange(uint16_t First, uint16_t Last)
+{
+    uint16_t Index            = m_locLib.GetNumberOfLocs();
+    uint16_t Address          = 0;
+    uint16_t NumberOfLocs     = 0;
+    uint16_t NumberOfFailures = 0;
+    uint32_t StartTime        = millis();
+    uint32_t Hash;
+
+    while (Index > 0)
+    {
+        Index--;
+        Address = m_locLib.LocGetAllDataByIndex(Index)->Addres;
+
+        if (Address < First)
+        {
+            break;
+        }
+        else if (Address <= Last)
+        {
+            /* The loc is known by its index, a search would rebuild the index after each removed loc. */
+            UndoRecord(undoOpDelete, Address, m_locLib.LocGetAllDataByIndex(Index));
+            Hash = LocRecordHash(m_locLib.LocGetAllDataByIndex(Index));
+            if (m_locLib.RemoveLoc(Address) == true)
+            {
+                m_RosterChecksum ^= Hash;
+                NumberOfLocs++;
+            }
+            else
+            {
+                NumberOfFailures++;
+            }
+        }
+    }
+
+    m_ChecksumNumberOfLocs = m_locLib.GetNumberOfLocs();
+    LocIndexInvalidate();
+    RangeReport("deleted", NumberOfLocs, NumberOfFailures, StartTime);
+
+    return (NumberOfLocs > 0);
+}
+
+/***********************************************************************************************************************
+ */
+bool WmcCli::ChangeRange(uint16_t First, uint16_t Last, uint16_t Button, uint16_t Function)
+{
+    uint8_t FunctionAssignment[5];
+    uint16_t Index            = 0;
+    uint16_t NumberOfLocs     = 0;
+    uint16_t NumberOfFailures = 0;
+    uint32_t StartTime        = millis();
+    LocLibData* Data;
+
+    if ((Button < 5) && (Function < 29))
+    {
+        while (Index < m_locLib.GetNumberOfLocs())
+        {
+            Data = m_locLib.LocGetAllDataByIndex(Index);
+
+            if (Data->Addres > Last)
+            {
+                break;
+            }
+            else if (Data->Addres >= First)
+            {
+                memcpy(FunctionAssignment, Data->FunctionAssignment, sizeof(FunctionAssignment));
+                FunctionAssignment[Button] = Function;
+                UndoRecord(undoOpChange, Data->Addres, Data);
+                m_RosterChecksum ^= LocRecordHash(Data);
+                if (m_locLib.StoreLoc(Data->Addres, FunctionAssignment, NULL, LocLib::storeChange) == true)
+                {
+                    NumberOfLocs++;
+                }
+                else
+                {
+                    NumberOfFailures++;
+                }
+                m_RosterChecksum ^= LocRecordHash(Data);
+            }
+
+            Index++;
+        }
+
+        RangeReport("updated", NumberOfLocs, NumberOfFailures, StartTime);
+    }
+    else
+    {
+        Serial.println("Invalid button (0..4) or function (0..28) number.");
+    }
+
+    return (NumberOfLocs > 0);
+}
+
+/***********************************************************************************************************************
+ */
+bool WmcCli::SetNameRange(uint16_t First, uint16_t Last, const char* NamePtr)
+{
+    char Name[WMC_CLI_NAME_LENGTH + 1];
+    uint16_t Index            = 0;
+    uint16_t NumberOfLocs     = 0;
+    uint16_t NumberOfFailures = 0;
+    uint32_t StartTime        = millis();
+    bool Prefix               = false;
+    LocLibData* Data;
+
+    if (strncmp(NamePtr, "prefix ", 7) == 0)
+    {
+        NamePtr += 7;
+        Prefix = true;
+    }
+
+    while (Index < m_locLib.GetNumberOfLocs())
+    {
+        Data = m_locLib.LocGetAllDataByIndex(Index);
+
+        if (Data->Addres > Last)
+        {
+            break;
+        }
+        else if (Data->Addres >= First)
+        {
+            if (Prefix == true)
+            {
+                snprintf(Name, sizeof(Name), "%s%hu", NamePtr, Data->Addres);
+            }
+            else
+            {
+                snprintf(Name, sizeof(Name), "%s", NamePtr);
+            }
+
+            UndoRecord(undoOpName, Data->Addres, Data);
+            m_RosterChecksum ^= LocRecordHash(Data);
+            if (m_locLib.StoreLoc(Data->Addres, NULL, Name, LocLib::storeChange) == true)
+            {
+                NamePoolStore(Data->Addres, Name);
+                NumberOfLocs++;
+            }
+            else
+            {
+                NumberOfFailures++;
+            }
+            m_RosterChecksum ^= LocRecordHash(Data);
+        }
+
+        Index++;
+    }
+
+    RangeReport("renamed", NumberOfLocs, NumberOfFailures, StartTime);
+
+    return (NumberOfLocs > 0);
+}
+
+/***********************************************************************************************************************
+ */
+void WmcCli::RangeReport(const char* ActionPtr, uint16_t NumberOfLocs, uint16_t NumberOfFailures, uint32_t StartTime)
+{
+    if (NumberOfLocs > 0)
+    {
+        ChangeSet(cliChangeRoster);
+    }
+
+    Serial.print(NumberOfLocs);
+    Serial.print(" locs ");
+    Serial.print(ActionPtr);
+    Serial.print(", ");
+    Serial.print(NumberOfFailures);
+    Serial.print(" failed in ");
+    Serial.print(millis() - StartTime);
+    Serial.println(" ms.");
+}
+
+/***********************************************************************************************************************
+ */
+void WmcCli::ListAllLocs(void)
+{
+    uint16_t Index        = 0;
+    uint16_t NumberOfLocs = m_locLib.GetNumberOfLocs();
+    LocLibData* Data;
+    char Name[WMC_CLI_NAME_LENGTH + 1];
+    char output[34 + WMC_CLI_NAME_LENGTH];
+
+    /* Print header, the name column fits the longest name. */
+    sprintf(output, "          Functions%*s", WMC_CLI_NAME_LENGTH + 5, "");
+    Serial.print(output);
+    Serial.println(output);
+    sprintf(output, "Address B0 B1 B2 B3 B4  %-*s", WMC_CLI_NAME_LENGTH, "Name");
+    Serial.print(output);
+    Serial.println(output);
+
+    /* Print two locs with info on one line. */
+    while (Index < NumberOfLocs)
+    {
+        Data = m_locLib.LocGetAllDataByIndex(Index);
+        NameGet(Data, Name);
+        sprintf(output, "%4hu    %2hu %2hu %2hu %2hu %2hu  %-*s", Data->Addres, Data->FunctionAssignment[0],
+            Data->FunctionAssignment[1], Data->FunctionAssignment[2], Data->FunctionAssignment[3],
+            Data->FunctionAssignment[4], WMC_CLI_NAME_LENGTH, Name);
+        Serial.print(output);
+
+        Index++;
+        if ((Index % 2) == 0)
+        {
+            Serial.println();
+        }
+    }
+
+    if ((Index % 2) != 0)
+    {
+        Serial.println();
+    }
+
+    /* The generation allows a host to detect changes made after the list was read. */
+    Serial.print(NumberOfLocs);
+    Serial.print(" locs, generation ");
+    Serial.println(m_RosterGeneration);
+}
+
+/***********************************************************************************************************************
+ */
+uint8_t WmcCli::NameGet(LocLibData* DataPtr, char* NamePtr)
+{
+    uint16_t Used   = (m_CliEepValid == true) ? NamePoolUsedGet() : 0;
+    uint16_t Offset = NamePoolFind(Used, DataPtr->Addres, 0);
+    uint8_t Result  = 0;
+
+    /* The loc lib keeps the first characters of a long name, a different name was stored outside the cli. */
+    if ((Offset != NamePoolNotFound) && (strlen(DataPtr->Name) == (sizeof(LocLibData::Name) - 1)))
+    {
+        Result = NamePoolDecode(Used, Offset, NamePtr);
+        if (strncmp(NamePtr, DataPtr->Name, sizeof(LocLibData::Name) - 1) != 0)
+        {
+            Result = 0;
+        }
+    }
+
+    if (Result == 0)
+    {
+        strcpy(NamePtr, DataPtr->Name);
+        Result = strlen(NamePtr);
+    }
+
+    return (Result);
+}
+
+/***********************************************************************************************************************
+ * Each entry contains the address (big endian, 0 for a prefix), a header with the prefix number (bit 7..5) and the
+ * number of symbols (bit 4..0) followed by the 6 bit symbols. Symbols are an index in NamePoolCharacters, the escape
+ * symbol is followed by an index in NamePoolPunctuation. A leading word shared by several names (like "BR ") is stored
+ * once as prefix entry which is referenced by the entries of the names.
+ */
+uint8_t WmcCli::NamePoolStore(uint16_t Address, const char* NamePtr)
+{
+    char Text[WMC_CLI_NAME_LENGTH + 1];
+    const char* Space;
+    uint16_t Used        = (m_CliEepValid == true) ? NamePoolUsedGet() : 0;
+    uint16_t Offset      = NamePoolFind(Used, Address, 0);
+    uint8_t PrefixLength = 0;
+    uint8_t Prefix       = 0;
+    uint8_t Result       = strlen(NamePtr);
+
+    if (Offset != NamePoolNotFound)
+    {
+        NamePoolRemove(&Used, Offset);
+    }
+
+    if ((Result >= sizeof(LocLibData::Name)) && (m_CliEepValid == false))
+    {
+        Result = sizeof(LocLibData::Name) - 1;
+    }
+    else if (Result >= sizeof(LocLibData::Name))
+    {
+        if (Result > WMC_CLI_NAME_LENGTH)
+        {
+            Result = WMC_CLI_NAME_LENGTH;
+        }
+
+        memcpy(Text, NamePtr, Result);
+        Text[Result] = '\0';
+
+        /* The leading word including the space is the candidate for a prefix. */
+        Space = strchr(Text, ' ');
+        if ((Space != NULL) && (Space > Text) && ((Space - Text) < NamePoolPrefixLength))
+        {
+            PrefixLength = (uint8_t)(Space - Text) + 1;
+            Prefix       = NamePoolPrefixGet(&Used, Text, PrefixLength);
+        }
+
+        if (NamePoolAppend(&Used, Address, Prefix, &Text[(Prefix != 0) ? PrefixLength : 0], Result) == false)
+        {
+            /* Make room and try again, the compaction may have removed an unused prefix. */
+            NamePoolCompact(&Used);
+            Prefix = (PrefixLength != 0) ? NamePoolPrefixGet(&Used, Text, PrefixLength) : 0;
+            if (NamePoolAppend(&Used, Address, Prefix, &Text[(Prefix != 0) ? PrefixLength : 0], Result) == false)
+            {
+                Result = sizeof(LocLibData::Name) - 1;
+            }
+        }
+    }
+
+    return (Result);
+}
+
+/***********************************************************************************************************************
+ */
+uint16_t WmcCli::NamePoolUsedGet(void)
+{
+    uint16_t Result = ((uint16_t)(EEPROM.read(NamePoolEepAddress)) << 8) | EEPROM.read(NamePoolEepAddress + 1);
+    uint16_t Offset = 0;
+
+    if (Result <= (WMC_CLI_NAME_POOL_SIZE - 2))
+    {
+        while (Offset < Result)
+        {
+            Offset += NamePoolEntrySize(Offset);
+        }
+    }
+
+    /* Erased EEPROM or an entry which does not end at the end of the used bytes. */
+    if ((Result > (WMC_CLI_NAME_POOL_SIZE - 2)) || (Offset != Result))
+    {
+        Result = 0;
+        NamePoolUsedSet(0);
+    }
+
+    return (Result);
+}
+
+/***********************************************************************************************************************
+ */
+void WmcCli::NamePoolUsedSet(uint16_t Used)
+{
+    EEPROM.write(NamePoolEepAddress, (uint8_t)(Used >> 8));
+    EEPROM.write(NamePoolEepAddress + 1, (uint8_t)(Used));
+}
+
+/***********************************************************************************************************************
+ */
+uint16_t WmcCli::NamePoolFind(uint16_t Used, uint16_t Address, uint8_t Prefix)
+{
+    uint16_t Offset = 0;
+    uint16_t EntryAddress;
+    uint16_t Result = NamePoolNotFound;
+
+    while ((Offset < Used) && (Result == NamePoolNotFound))
+    {
+        EntryAddress = ((uint16_t)(EEPROM.read(NamePoolEepAddress + 2 + Offset)) << 8)
+            | EEPROM.read(NamePoolEepAddress + 3 + Offset);
+
+        if ((EntryAddress == Address)
+            && ((Address != 0) || ((EEPROM.read(NamePoolEepAddress + 4 + Offset) >> 5) == Prefix)))
+        {
+            Result = Offset;
+        }
+
+        Offset += NamePoolEntrySize(Offset);
+    }
+
+    return (Result);
+}
+
+/***********************************************************************************************************************
+ */
+uint8_t WmcCli::NamePoolEntrySize(uint16_t Offset)
+{
+    return (3 + ((((EEPROM.read(NamePoolEepAddress + 4 + Offset) & 0x1F) * 6) + 7) / 8));
+}
+
+/***********************************************************************************************************************
+ */
+uint8_t WmcCli::NamePoolDecode(uint16_t Used, uint16_t Offset, char* NamePtr)
+{
+    uint16_t Data   = NamePoolEepAddress + 5 + Offset;
+    uint8_t Header  = EEPROM.read(NamePoolEepAddress + 4 + Offset);
+    uint8_t Bytes   = NamePoolEntrySize(Offset) - 3;
+    uint8_t Length  = 0;
+    uint8_t Index   = 0;
+    uint16_t Prefix = NamePoolNotFound;
+    uint16_t Word   = 0;
+    uint8_t Symbol  = 0;
+    bool Escape     = false;
+    char Character;
+
+    if ((Header >> 5) != 0)
+    {
+        if ((EEPROM.read(NamePoolEepAddress + 2 + Offset) != 0) || (EEPROM.read(NamePoolEepAddress + 3 + Offset) != 0))
+        {
+            Prefix = NamePoolFind(Used, 0, Header >> 5);
+        }
+    }
+
+    if (Prefix != NamePoolNotFound)
+    {
+        Length = NamePoolDecode(Used, Prefix, NamePtr);
+    }
+
+    for (Index = 0; Index < (Header & 0x1F); Index++)
+    {
+        Word = (uint16_t)(EEPROM.read(Data + ((Index * 6) / 8))) << 8;
+        if ((((Index * 6) / 8) + 1) < Bytes)
+        {
+            Word |= EEPROM.read(Data + ((Index * 6) / 8) + 1);
+        }
+        Symbol = (uint8_t)(Word >> (10 - ((Index * 6) % 8))) & 0x3F;
+
+        if (Escape == true)
+        {
+            Character = (Symbol < strlen(NamePoolPunctuation)) ? NamePoolPunctuation[Symbol] : '?';
+            Escape    = false;
+        }
+        else if (Symbol == NamePoolEscape)
+        {
+            Character = '\0';
+            Escape    = true;
+        }
+        else
+        {
+            Character = NamePoolCharacters[Symbol];
+        }
+
+        if ((Character != '\0') && (Length < WMC_CLI_NAME_LENGTH))
+        {
+            NamePtr[Length] = Character;
+            Length++;
+        }
+    }
+
+    NamePtr[Length] = '\0';
+
+    return (Length);
+}
+
+/***********************************************************************************************************************
+ * A prefix only saves space when it is shared, so it is created when a second name with the same leading word is
+ * stored. The names already in the pool with that word are stored again with a reference to the prefix.
+ */
+uint8_t WmcCli::NamePoolPrefixGet(uint16_t* UsedPtr, const char* TextPtr, uint8_t Length)
+{
+    char Name[WMC_CLI_NAME_LENGTH + 1];
+    uint16_t Offset = 0;
+    uint16_t Address;
+    uint8_t Header;
+    uint8_t InUse  = 0;
+    uint8_t Free   = 0;
+    uint8_t Prefix = 0;
+    uint8_t Result = 0;
+
+    while ((Offset < *UsedPtr) && (Result == 0))
+    {
+        Address = ((uint16_t)(EEPROM.read(NamePoolEepAddress + 2 + Offset)) << 8)
+            | EEPROM.read(NamePoolEepAddress + 3 + Offset);
+        Header = EEPROM.read(NamePoolEepAddress + 4 + Offset);
+
+        if (Address == 0)
+        {
+            InUse |= (uint8_t)(1 << (Header >> 5));
+            if ((NamePoolDecode(*UsedPtr, Offset, Name) == Length) && (strncmp(Name, TextPtr, Length) == 0))
+            {
+                Result = Header >> 5;
+            }
+        }
+
+        Offset += NamePoolEntrySize(Offset);
+    }
+
+    for (Prefix = NamePoolPrefixes; (Prefix > 0) && (Result == 0); Prefix--)
+    {
+        if ((InUse & (1 << Prefix)) == 0)
+        {
+            Free = Prefix;
+        }
+    }
+
+    Offset = 0;
+    while ((Result == 0) && (Free != 0) && (Offset < *UsedPtr))
+    {
+        Address = ((uint16_t)(EEPROM.read(NamePoolEepAddress + 2 + Offset)) << 8)
+            | EEPROM.read(NamePoolEepAddress + 3 + Offset);
+        Header = EEPROM.read(NamePoolEepAddress + 4 + Offset);
+
+        if ((Address != 0) && ((Header >> 5) == 0) && (NamePoolDecode(*UsedPtr, Offset, Name) > Length)
+            && (strncmp(Name, TextPtr, Length) == 0))
+        {
+            if (NamePoolAppend(UsedPtr, 0, Free, TextPtr, Length) == true)
+            {
+                Result = Free;
+            }
+            else
+            {
+                Free = 0;
+            }
+        }
+        else
+        {
+            Offset += NamePoolEntrySize(Offset);
+        }
+    }
+
+    /* The entry found and any further names with the same word now use the prefix, the new entries are smaller. */
+    while ((Result != 0) && (Free != 0) && (Offset < *UsedPtr))
+    {
+        Address = ((uint16_t)(EEPROM.read(NamePoolEepAddress + 2 + Offset)) << 8)
+            | EEPROM.read(NamePoolEepAddress + 3 + Offset);
+        Header = EEPROM.read(NamePoolEepAddress + 4 + Offset);
+
+        if ((Address != 0) && ((Header >> 5) == 0) && (NamePoolDecode(*UsedPtr, Offset, Name) > Length)
+            && (strncmp(Name, TextPtr, Length) == 0))
+        {
+            NamePoolRemove(UsedPtr, Offset);
+            NamePoolAppend(UsedPtr, Address, Result, &Name[Length], strlen(Name) - Length);
+        }
+        else
+        {
+            Offset += NamePoolEntrySize(Offset);
+        }
+    }
+
+    return (Result);
+}
+
+/***********************************************************************************************************************
+ */
+bool WmcCli::NamePoolAppend(uint16_t* UsedPtr, uint16_t Address, uint8_t Prefix, const char* TextPtr, uint8_t Length)
+{
+    uint8_t Packed[((NamePoolSymbols * 6) + 7) / 8];
+    uint8_t Codes[2];
+    uint8_t NumberOfCodes;
+    uint8_t Symbols = 0;
+    uint8_t Index;
+    uint8_t Code;
+    uint16_t Word;
+    uint16_t Used   = *UsedPtr;
+    const char* Found;
+    bool Result = true;
+
+    memset(Packed, 0, sizeof(Packed));
+
+    for (Index = 0; (Index < Length) && (TextPtr[Index] != '\0') && (Result == true); Index++)
+    {
+        Found         = strchr(NamePoolCharacters, TextPtr[Index]);
+        NumberOfCodes = 1;
+        if (Found != NULL)
+        {
+            Codes[0] = (uint8_t)(Found - NamePoolCharacters);
+        }
+        else
+        {
+            /* Characters without a symbol and without escape code can not be stored. */
+            Found = strchr(NamePoolPunctuation, TextPtr[Index]);
+            if (Found != NULL)
+            {
+                Codes[0]      = NamePoolEscape;
+                Codes[1]      = (uint8_t)(Found - NamePoolPunctuation);
+                NumberOfCodes = 2;
+            }
+            else
+            {
+                Result = false;
+            }
+        }
+
+        for (Code = 0; (Code < NumberOfCodes) && (Result == true); Code++)
+        {
+            if (Symbols < NamePoolSymbols)
+            {
+                Word = (uint16_t)(Codes[Code]) << (10 - ((Symbols * 6) % 8));
+                Packed[(Symbols * 6) / 8] |= (uint8_t)(Word >> 8);
+                Packed[((Symbols * 6) / 8) + 1] |= (uint8_t)(Word);
+                Symbols++;
+            }
+            else
+            {
+                Result = false;
+            }
+        }
+    }
+
+    if ((Result == true) && ((Used + 3 + (((Symbols * 6) + 7) / 8)) <= (WMC_CLI_NAME_POOL_SIZE - 2)))
+    {
+        EEPROM.write(NamePoolEepAddress + 2 + Used, (uint8_t)(Address >> 8));
+        EEPROM.write(NamePoolEepAddress + 3 + Used, (uint8_t)(Address));
+        EEPROM.write(NamePoolEepAddress + 4 + Used, (uint8_t)(Prefix << 5) | Symbols);
+        for (Index = 0; Index < (((Symbols * 6) + 7) / 8); Index++)
+        {
+            EEPROM.write(NamePoolEepAddress + 5 + Used + Index, Packed[Index]);
+        }
+        *UsedPtr = Used + 3 + (((Symbols * 6) + 7) / 8);
+        NamePoolUsedSet(*UsedPtr);
+    }
+    else
+    {
+        Result = false;
+    }
+
+    return (Result);
+}
+
+/***********************************************************************************************************************
+ */
+void WmcCli::NamePoolRemove(uint16_t* UsedPtr, uint16_t Offset)
+{
+    uint8_t Size = NamePoolEntrySize(Offset);
+    uint16_t Index;
+
+    for (Index = Offset + Size; Index < *UsedPtr; Index++)
+    {
+        EEPROM.write(NamePoolEepAddress + 2 + Index - Size, EEPROM.read(NamePoolEepAddress + 2 + Index));
+    }
+
+    *UsedPtr -= Size;
+    NamePoolUsedSet(*UsedPtr);
+}
+
+/***********************************************************************************************************************
+ * Entries of deleted locs are kept until room is needed, so an undo or profile load which adds the loc again with
+ * the same name also restores the long name.
+ */
+void WmcCli::NamePoolCompact(uint16_t* UsedPtr)
+{
+    char Name[WMC_CLI_NAME_LENGTH + 1];
+    LocLibData* DataPtr;
+    uint16_t Offset;
+    uint16_t Address;
+    uint16_t Index;
+    uint8_t Pass;
+    uint8_t Prefix;
+    bool Keep;
+
+    /* Remove the loc entries first, so the prefixes only used by them are removed in the second pass. */
+    for (Pass = 0; Pass < 2; Pass++)
+    {
+        Offset = 0;
+        while (Offset < *UsedPtr)
+        {
+            Address = ((uint16_t)(EEPROM.read(NamePoolEepAddress + 2 + Offset)) << 8)
+                | EEPROM.read(NamePoolEepAddress + 3 + Offset);
+            Prefix = EEPROM.read(NamePoolEepAddress + 4 + Offset) >> 5;
+            Keep   = true;
+
+            if ((Pass == 0) && (Address != 0))
+            {
+                /* Same check as NameGet() on this entry, without a new walk of the pool. */
+                Index = LocIndexFind(Address);
+                Keep  = false;
+                if (Index != LocIndexNotFound)
+                {
+                    DataPtr = m_locLib.LocGetAllDataByIndex(Index);
+                    Keep    = (strlen(DataPtr->Name) == (sizeof(LocLibData::Name) - 1))
+                        && (NamePoolDecode(*UsedPtr, Offset, Name) >= sizeof(LocLibData::Name))
+                        && (strncmp(Name, DataPtr->Name, sizeof(LocLibData::Name) - 1) == 0);
+                }
+            }
+            else if ((Pass == 1) && (Address == 0))
+            {
+                Keep  = false;
+                Index = 0;
+                while ((Index < *UsedPtr) && (Keep == false))
+                {
+                    Keep = ((EEPROM.read(NamePoolEepAddress + 2 + Index) != 0)
+                               || (EEPROM.read(NamePoolEepAddress + 3 + Index) != 0))
+                        && ((EEPROM.read(NamePoolEepAddress + 4 + Index) >> 5) == Prefix);
+                    Index += NamePoolEntrySize(Index);
+                }
+            }
+
+            if (Keep == true)
+            {
+                Offset += NamePoolEntrySize(Offset);
+            }
+            else
+            {
+                NamePoolRemove(UsedPtr, Offset);
+            }
+        }
+    }
+}
+
+/***********************************************************************************************************************
+ */
+bool WmcCli::EmergencyChange(void)
+{
+    char* Space;
+    uint8_t EmergencyOption;
+    bool Result = false;
+
+    Space = strchr(m_bufferRx, 32);
+
+    if (Space != NULL)
+    {
+        Space++;
+
+        EmergencyOption = atoi(Space);
+
+        switch (EmergencyOption)
+        {
+        case 0:
+            m_LocStorage.EmergencyOptionSet(0);
+            Serial.println("Stop option set to power off.");
+            Result = true;
+            break;
+        case 1:
+            m_LocStorage.EmergencyOptionSet(1);
+            Serial.println("Stop option set to emergency stop");
+            Result = true;
+            break;
+        default:
+            Serial.println("Emergency entry invalid, set to power off.");
+            m_LocStorage.EmergencyOptionSet(0);
+            break;
+        }
+    }
+    else
+    {
+        Serial.println("Emergency option entry invalid, must be emergency 0 or emergency 1");
+    }
+
+    SettingsChecksumUpdate();
+    ChangeSet(cliChangeEmergency);
+
+    return (Result);
+}
+/***********************************************************************************************************************
+ */
+bool WmcCli::AcControlType(void)
+{
+    uint8_t AcOption;
+    char* Space;
+    bool Result = false;
+
+    Space = strchr(m_bufferRx, 32);
+
+    if (Space != NULL)
+    {
+        Space++;
+
+        AcOption = atoi(Space);
+
+        switch (AcOption)
+        {
+        case 0:
+            m_LocStorage.AcOptionSet(AcOption);
+            Serial.println("AC option disabled.");
+            Result = true;
+            break;
+        case 1:
+            m_LocStorage.AcOptionSet(AcOption);
+            Serial.println("AC option enabled.");
+            Result = true;
+            break;
+        default:
+            Serial.println("AC option entry invalid, option set to disabled.");
+            m_LocStorage.AcOptionSet(0);
+            break;
+        }
+    }
+    else
+    {
+        Serial.println("AC option entry invalid, must be ac 0 or ac 1");
+    }
+
+    SettingsChecksumUpdate();
+    ChangeSet(cliChangeAc);
+
+    return (Result);
+}
+
+#if WMC_CLI_MODULE_MACRO == 1
+/***********************************************************************************************************************
+ */
+bool WmcCli::MacroCommand(void)
+{
+    char* Space;
+    char* NamePtr;
+    char Name[MacroNameLength + 1];
+    uint8_t Slot;
+    uint8_t NumberOfArgs = 0;
+    uint16_t Args[4];
+    bool Result = false;
+
+    Space = &m_bufferRx[strlen(Macro)];
+
+    if (strncmp(Space, "record ", 7) == 0)
+    {
+        NamePtr = &Space[7];
+        if (m_MacroRecording == true)
+        {
+            /* A new recording would discard the buffered one. */
+            Serial.println("Macro recording active, stop with macro end or macro abort first.");
+        }
+        else if ((strlen(NamePtr) > 0) && (strlen(NamePtr) <= MacroNameLength) && (strchr(NamePtr, ' ') == NULL))
+        {
+            memset(m_Scratch.MacroBuffer, 0, sizeof(m_Scratch.MacroBuffer));
+            memcpy(m_Scratch.MacroBuffer, NamePtr, strlen(NamePtr));
+            m_MacroRecording = true;
+            Serial.print("Recording macro ");
+            Serial.print(NamePtr);
+            Serial.println(", stop with macro end.");
+        }
+        else
+        {
+            Serial.println("Macro name invalid, 1..8 characters without spaces.");
+        }
+    }
+    else if (strncmp(Space, "end", 3) == 0)
+    {
+        if (m_MacroRecording == true)
+        {
+            m_MacroRecording = false;
+
+            /* Overwrite a macro with the same name, otherwise use a free slot. A name of MacroNameLength characters
+             * is followed by the code size instead of a terminator. */
+            memcpy(Name, m_Scratch.MacroBuffer, MacroNameLength);
+            Name[MacroNameLength] = '\0';
+            Slot                  = MacroSlotFind(Name);
+            if (Slot == 255)
+            {
+                Slot = MacroSlotFind(NULL);
+            }
+
+            if (Slot != 255)
+            {
+                for (uint8_t Index = 0; Index < sizeof(m_Scratch.MacroBuffer); Index++)
+                {
+                    EEPROM.write(MacroEepAddress + (Slot * MacroSlotSize) + Index, m_Scratch.MacroBuffer[Index]);
+                }
+                EepCommit();
+
+                Serial.print("Macro stored, ");
+                Serial.print(m_Scratch.MacroBuffer[MacroCodeSizeOffset]);
+                Serial.println(" bytes.");
+            }
+            else
+            {
+                Serial.println("No free macro slot, delete a macro first.");
+            }
+        }
+        else
+        {
+            Serial.println("No macro recording active.");
+        }
+    }
+    else if (strncmp(Space, "abort", 5) == 0)
+    {
+        if (m_MacroRecording == true)
+        {
+            m_MacroRecording = false;
+            Serial.println("Macro recording aborted, nothing stored.");
+        }
+        else
+        {
+            Serial.println("No macro recording active.");
+        }
+    }
+    else if (strncmp(Space, "run ", 4) == 0)
+    {
+        if (m_MacroRecording == false)
+        {
+            /* Split name and the address arguments. */
+            NamePtr = &Space[4];
+            Space   = strchr(NamePtr, ' ');
+            while ((Space != NULL) && (NumberOfArgs < 4))
+            {
+                *Space = '\0';
+                Space++;
+                Args[NumberOfArgs] = atoi(Space);
+                NumberOfArgs++;
+                Space = strchr(Space, ' ');
+            }
+
+            Slot = MacroSlotFind(NamePtr);
+            if (Slot != 255)
+            {
+                Result = MacroRun(Slot, Args, NumberOfArgs);
+            }
+            else
+            {
+                Serial.println("Macro not present.");
+            }
+        }
+        else
+        {
+            Serial.println("Macro run not possible while recording.");
+        }
+    }
+    else if (strncmp(Space, "list", 4) == 0)
+    {
+        MacroList();
+    }
+    else if (strncmp(Space, "del ", 4) == 0)
+    {
+        Slot = MacroSlotFind(&Space[4]);
+        if (Slot != 255)
+        {
+            EEPROM.write(MacroEepAddress + (Slot * MacroSlotSize), 0);
+            EepCommit();
+            Serial.println("Macro deleted.");
+        }
+        else
+        {
+            Serial.println("Macro not present.");
+        }
+    }
+    else
+    {
+        Serial.println("Macro command invalid.");
+    }
+
+    return (Result);
+}
+
+/***********************************************************************************************************************
+ * Store the command as opcode followed by the (big endian) address and the command specific data, so a macro run
+ * does not need to parse text anymore.
+ */
+bool WmcCli::MacroRecordLine(void)
+{
+    char* Space;
+    uint8_t Op[4 + sizeof(m_bufferRx)];
+    uint8_t OpSize   = 0;
+    uint8_t CodeSize = m_Scratch.MacroBuffer[MacroCodeSizeOffset];
+    uint16_t Address = 0;
+    uint16_t Value;
+    bool Result = false;
+
+    Space = strchr(m_bufferRx, ' ');
+
+    if (Space != NULL)
+    {
+        Space++;
+        Value = atoi(Space);
+
+        if (strncmp(m_bufferRx, Emergency, strlen(Emergency)) == 0)
+        {
+            if (Value <= 1)
+            {
+                Op[0]  = macroOpEmergency;
+                Op[1]  = (uint8_t)(Value);
+                OpSize = 2;
+            }
+        }
+        else if (strncmp(m_bufferRx, Ac, strlen(Ac)) == 0)
+        {
+            if (Value <= 1)
+            {
+                Op[0]  = macroOpAc;
+                Op[1]  = (uint8_t)(Value);
+                OpSize = 2;
+            }
+        }
+        else
+        {
+            Address = MacroArgGet(Space);
+            Op[1]   = (uint8_t)(Address >> 8);
+            Op[2]   = (uint8_t)(Address & 0xFF);
+
+            if ((Address == 0) || ((Address > 9999) && ((Address & MacroArgReference) == 0))
+                || (RangeGet(Space, &Value) == true))
+            {
+                /* Invalid address or address range, nothing to record. */
+            }
+            else if (strncmp(m_bufferRx, LocAdd, strlen(LocAdd)) == 0)
+            {
+                Op[0]  = macroOpAdd;
+                OpSize = 3;
+            }
+            else if (strncmp(m_bufferRx, LocDelete, strlen(LocDelete)) == 0)
+            {
+                Op[0]  = macroOpDelete;
+                OpSize = 3;
+            }
+            else if (strncmp(m_bufferRx, LocChange, strlen(LocChange)) == 0)
+            {
+                Space = strchr(Space, ' ');
+                if (Space != NULL)
+                {
+                    Space++;
+                    Op[3] = (uint8_t)(atoi(Space));
+                    Space = strchr(Space, ' ');
+                    if (Space != NULL)
+                    {
+                        Space++;
+                        Op[4] = (uint8_t)(atoi(Space));
+                        if ((Op[3] < 5) && (Op[4] < 29))
+                        {
+                            Op[0]  = macroOpChange;
+                            OpSize = 5;
+                        }
+                    }
+                }
+            }
+            else if (strncmp(m_bufferRx, LocName, strlen(LocName)) == 0)
+            {
+                Space = strchr(Space, ' ');
+                if (Space != NULL)
+                {
+                    Space++;
+                    Op[0]  = macroOpName;
+                    Op[3]  = (uint8_t)(strlen(Space));
+                    OpSize = 4 + Op[3];
+                    memcpy(&Op[4], Space, Op[3]);
+                }
+            }
+        }
+    }
+
+    if (OpSize == 0)
+    {
+        Serial.println("Command can not be recorded.");
+    }
+    else if ((size_t)(MacroCodeOffset + CodeSize + OpSize) > sizeof(m_Scratch.MacroBuffer))
+    {
+        Serial.println("Macro full, command not recorded.");
+    }
+    else
+    {
+        memcpy(&m_Scratch.MacroBuffer[MacroCodeOffset + CodeSize], Op, OpSize);
+        m_Scratch.MacroBuffer[MacroCodeSizeOffset] = CodeSize + OpSize;
+        Serial.println("Recorded.");
+        Result = true;
+    }
+
+    return (Result);
+}
+
+/***********************************************************************************************************************
+ */
+uint16_t WmcCli::MacroArgGet(const char* StrPtr)
+{
+    uint16_t Arg;
+
+    if (StrPtr[0] == '$')
+    {
+        Arg = atoi(&StrPtr[1]);
+        if ((Arg >= 1) && (Arg <= 4))
+        {
+            Arg = MacroArgReference | (Arg - 1);
+        }
+        else
+        {
+            Arg = 0;
+        }
+    }
+    else
+    {
+        Arg = atoi(StrPtr);
+    }
+
+    return (Arg);
+}
+
+/***********************************************************************************************************************
+ * Locate a macro by name, or a free slot when no name is given. A slot is free when the first name character is
+ * erased (0xFF) or cleared (0).
+ */
+uint8_t WmcCli::MacroSlotFind(const char* NamePtr)
+{
+    char Name[MacroNameLength + 1];
+    uint8_t Slot;
+    uint8_t Index;
+    uint8_t Result = 255;
+
+    for (Slot = 0; (Slot < MacroSlots) && (Result == 255); Slot++)
+    {
+        for (Index = 0; Index < MacroNameLength; Index++)
+        {
+            Name[Index] = (char)(EEPROM.read(MacroEepAddress + (Slot * MacroSlotSize) + Index));
+        }
+        Name[MacroNameLength] = '\0';
+
+        if ((Name[0] == '\0') || (Name[0] == (char)(0xFF)))
+        {
+            if (NamePtr == NULL)
+            {
+                Result = Slot;
+            }
+        }
+        else if ((NamePtr != NULL) && (strncmp(Name, NamePtr, MacroNameLength) == 0)
+            && (strlen(NamePtr) <= MacroNameLength))
+        {
+            Result = Slot;
+        }
+    }
+
+    return (Result);
+}
+
+/***********************************************************************************************************************
+ */
+bool WmcCli::MacroRun(uint8_t Slot, uint16_t* ArgsPtr, uint8_t NumberOfArgs)
+{
+    /* Size of each opcode including its operands, the name opcode is followed by Length characters. */
+    static const uint8_t OpcodeSize[macroOpEmergency + 1] = {0, 3, 3, 5, 4, 2, 2};
+    char Name[sizeof(m_bufferRx)];
+    uint8_t Index;
+    uint8_t Length;
+    uint8_t CodeEnd;
+    uint8_t Pc               = MacroCodeOffset;
+    uint8_t NumberOfCommands = 0;
+    uint16_t Address         = 0;
+    bool Valid               = true;
+    bool Result              = false;
+
+    for (Index = 0; Index < sizeof(m_Scratch.MacroBuffer); Index++)
+    {
+        m_Scratch.MacroBuffer[Index] = EEPROM.read(MacroEepAddress + (Slot * MacroSlotSize) + Index);
+    }
+
+    CodeEnd = MacroCodeOffset + m_Scratch.MacroBuffer[MacroCodeSizeOffset];
+    if (CodeEnd > sizeof(m_Scratch.MacroBuffer))
+    {
+        CodeEnd = MacroCodeOffset;
+        Valid   = false;
+    }
+
+    while ((Pc < CodeEnd) && (Valid == true))
+    {
+        /* Never read operands behind the recorded code, the slot may be corrupted or written with eep write. */
+        if ((m_Scratch.MacroBuffer[Pc] < macroOpAdd) || (m_Scratch.MacroBuffer[Pc] > macroOpEmergency)
+            || ((Pc + OpcodeSize[m_Scratch.MacroBuffer[Pc]]) > CodeEnd))
+        {
+            Valid = false;
+            break;
+        }
+
+        if (m_Scratch.MacroBuffer[Pc] <= macroOpName)
+        {
+            Address = ((uint16_t)(m_Scratch.MacroBuffer[Pc + 1]) << 8) | m_Scratch.MacroBuffer[Pc + 2];
+            if ((Address & MacroArgReference) != 0)
+            {
+                Index = (uint8_t)(Address & 0x03);
+                if (Index < NumberOfArgs)
+                {
+                    Address = ArgsPtr[Index];
+                }
+                else
+                {
+                    Serial.print("Macro argument $");
+                    Serial.print(Index + 1);
+                    Serial.println(" missing.");
+                    Valid = false;
+                    break;
+                }
+            }
+        }
+
+        switch (m_Scratch.MacroBuffer[Pc])
+        {
+        case macroOpAdd:
+            Result |= AddExecute(Address);
+            Pc += 3;
+            break;
+        case macroOpDelete:
+            Result |= DeleteExecute(Address);
+            Pc += 3;
+            break;
+        case macroOpChange:
+            Result |= ChangeExecute(Address, m_Scratch.MacroBuffer[Pc + 3], m_Scratch.MacroBuffer[Pc + 4]);
+            Pc += 5;
+            break;
+        case macroOpName:
+            Length = m_Scratch.MacroBuffer[Pc + 3];
+            if ((Length < sizeof(Name)) && ((Pc + 4 + Length) <= CodeEnd))
+            {
+                memcpy(Name, &m_Scratch.MacroBuffer[Pc + 4], Length);
+                Name[Length] = '\0';
+                Result |= SetNameExecute(Address, Name);
+            }
+            else
+            {
+                Valid = false;
+            }
+            Pc += 4 + Length;
+            break;
+        case macroOpAc:
+            if (m_Scratch.MacroBuffer[Pc + 1] <= 1)
+            {
+                m_LocStorage.AcOptionSet(m_Scratch.MacroBuffer[Pc + 1]);
+                ChangeSet(cliChangeAc);
+                Result = true;
+            }
+            else
+            {
+                Valid = false;
+            }
+            Pc += 2;
+            break;
+        case macroOpEmergency:
+            if (m_Scratch.MacroBuffer[Pc + 1] <= 1)
+            {
+                m_LocStorage.EmergencyOptionSet(m_Scratch.MacroBuffer[Pc + 1]);
+                ChangeSet(cliChangeEmergency);
+                Result = true;
+            }
+            else
+            {
+                Valid = false;
+            }
+            Pc += 2;
+            break;
+        default: Valid = false; break;
+        }
+
+        NumberOfCommands++;
+    }
+
+    SettingsChecksumUpdate();
+
+    if (Valid == true)
+    {
+        Serial.print("Macro done, ");
+        Serial.print(NumberOfCommands);
+        Serial.println(" commands executed.");
+    }
+    else
+    {
+        Serial.println("Macro aborted.");
+    }
+
+    return (Result);
+}
+
+/***********************************************************************************************************************
+ */
+void WmcCli::MacroList(void)
+{
+    uint8_t Slot;
+    uint8_t Index;
+    char Name;
+
+    for (Slot = 0; Slot < MacroSlots; Slot++)
+    {
+        Name = (char)(EEPROM.read(MacroEepAddress + (Slot * MacroSlotSize)));
+        if ((Name != '\0') && (Name != (char)(0xFF)))
+        {
+            for (Index = 0; Index < MacroNameLength; Index++)
+            {
+                Name = (char)(EEPROM.read(MacroEepAddress + (Slot * MacroSlotSize) + Index));
+                if (Name != '\0')
+                {
+                    Serial.print(Name);
+                }
+            }
+            Serial.print(" : ");
+            Serial.print(EEPROM.read(MacroEepAddress + (Slot * MacroSlotSize) + MacroCodeSizeOffset));
+            Serial.println(" bytes");
+        }
+    }
+}
+#endif
+
+#if WMC_CLI_MODULE_PROFILE == 1
+/***********************************************************************************************************************
+ * The first byte of the profile area contains the slot of the active profile, followed by the slots. A slot contains
+ * the name, the number of locs and for each loc the address (big endian), the functions and the name.
+ */
+void WmcCli::ProfileCommand(void)
+{
+    char* Space;
+    uint8_t Slot;
+
+    Space = &m_bufferRx[strlen(Profile)];
+
+    if (strncmp(Space, "save ", 5) == 0)
+    {
+        if ((strlen(&Space[5]) > 0) && (strlen(&Space[5]) <= ProfileNameLength) && (strchr(&Space[5], ' ') == NULL))
+        {
+            /* Overwrite a profile with the same name, otherwise use a free slot. */
+            Slot = ProfileSlotFind(&Space[5]);
+            if (Slot == 255)
+            {
+                Slot = ProfileSlotFind(NULL);
+            }
+
+            if (Slot != 255)
+            {
+                ProfileSave(Slot, &Space[5]);
+            }
+            else
+            {
+                Serial.println("No free profile slot, delete a profile first.");
+            }
+        }
+        else
+        {
+            Serial.println("Profile name invalid, 1..8 characters without spaces.");
+        }
+    }
+    else if (strncmp(Space, "load ", 5) == 0)
+    {
+        Slot = ProfileSlotFind(&Space[5]);
+        if (Slot != 255)
+        {
+            ProfileLoad(Slot);
+        }
+        else
+        {
+            Serial.println("Profile not present.");
+        }
+    }
+    else if (strncmp(Space, "list", 4) == 0)
+    {
+        ProfileList();
+    }
+    else if (strncmp(Space, "delete ", 7) == 0)
+    {
+        Slot = ProfileSlotFind(&Space[7]);
+        if (Slot != 255)
+        {
+            EEPROM.write(ProfileEepAddress + 1 + (Slot * ProfileSlotSize), 0);
+            if (EEPROM.read(ProfileEepAddress) == Slot)
+            {
+                EEPROM.write(ProfileEepAddress, 255);
+            }
+            EepCommit();
+            Serial.println("Profile deleted.");
+        }
+        else
+        {
+            Serial.println("Profile not present.");
+        }
+    }
+    else
+    {
+        Serial.println("Profile command invalid.");
+    }
+}
+
+/***********************************************************************************************************************
+ */
+uint8_t WmcCli::ProfileSlotFind(const char* NamePtr)
+{
+    char Name[ProfileNameLength + 1];
+    uint8_t Slot;
+    uint8_t Index;
+    uint8_t Result = 255;
+
+    for (Slot = 0; (Slot < WMC_CLI_PROFILE_SLOTS) && (Result == 255); Slot++)
+    {
+        for (Index = 0; Index < ProfileNameLength; Index++)
+        {
+            Name[Index] = (char)(EEPROM.read(ProfileEepAddress + 1 + (Slot * ProfileSlotSize) + Index));
+        }
+        Name[ProfileNameLength] = '\0';
+
+        if ((Name[0] == '\0') || (Name[0] == (char)(0xFF)))
+        {
+            if (NamePtr == NULL)
+            {
+                Result = Slot;
+            }
+        }
+        else if ((NamePtr != NULL) && (strncmp(Name, NamePtr, ProfileNameLength) == 0)
+            && (strlen(NamePtr) <= ProfileNameLength))
+        {
+            Result = Slot;
+        }
+    }
+
+    return (Result);
+}
+
+/***********************************************************************************************************************
+ */
+bool WmcCli::ProfileSave(uint8_t Slot, const char* NamePtr)
+{
+    uint16_t Address      = ProfileEepAddress + 1 + (Slot * ProfileSlotSize);
+    uint16_t NumberOfLocs = m_locLib.GetNumberOfLocs();
+    uint16_t Index;
+    bool Result = false;
+
+    if (NumberOfLocs <= WMC_CLI_PROFILE_LOCS)
+    {
+        for (Index = 0; Index < ProfileNameLength; Index++)
+        {
+            EEPROM.write(Address + Index, (Index < strlen(NamePtr)) ? NamePtr[Index] : '\0');
+        }
+        EEPROM.write(Address + ProfileNameLength, (uint8_t)(NumberOfLocs));
+        RosterStore(Address + ProfileNameLength + 1);
+
+        EEPROM.write(ProfileEepAddress, Slot);
+        EepCommit();
+
+        Serial.print("Profile stored, ");
+        Serial.print(NumberOfLocs);
+        Serial.println(" locs.");
+        Result = true;
+    }
+    else
+    {
+        Serial.print("Too many locs for a profile, max ");
+        Serial.println(WMC_CLI_PROFILE_LOCS);
+    }
+
+    return (Result);
+}
+
+/***********************************************************************************************************************
+ * All records are checked before the roster is touched, an invalid profile leaves the roster unchanged.
+ */
+bool WmcCli::ProfileLoad(uint8_t Slot)
+{
+    uint16_t Address     = ProfileEepAddress + 1 + (Slot * ProfileSlotSize);
+    uint32_t StartTime   = millis();
+    uint8_t NumberOfLocs = EEPROM.read(Address + ProfileNameLength);
+    bool Result          = false;
+
+    if (RosterRecordsValid(Address + ProfileNameLength + 1, NumberOfLocs) == false)
+    {
+        Serial.println("Profile data invalid.");
+    }
+    else
+    {
+        UndoRecord(undoOpClear, 0, NULL);
+        Result = RosterLoad(Address + ProfileNameLength + 1, NumberOfLocs);
+        ChangeSet(cliChangeRoster);
+
+        if (Result == true)
+        {
+            EEPROM.write(ProfileEepAddress, Slot);
+            EepCommit();
+            Serial.print("Profile loaded, ");
+            Serial.print(NumberOfLocs);
+            Serial.print(" locs in ");
+            Serial.print(millis() - StartTime);
+            Serial.println(" ms.");
+        }
+        else
+        {
+            Serial.println("Profile load failed, loc storage full!");
+        }
+    }
+
+    return (Result);
+}
+
+/***********************************************************************************************************************
+ */
+void WmcCli::ProfileList(void)
+{
+    uint8_t Slot;
+    uint8_t Index;
+    uint16_t Address;
+    char Name;
+
+    for (Slot = 0; Slot < WMC_CLI_PROFILE_SLOTS; Slot++)
+    {
+        Address = ProfileEepAddress + 1 + (Slot * ProfileSlotSize);
+        Name    = (char)(EEPROM.read(Address));
+        if ((Name != '\0') && (Name != (char)(0xFF)))
+        {
+            Serial.print((EEPROM.read(ProfileEepAddress) == Slot) ? "* " : "  ");
+            for (Index = 0; Index < ProfileNameLength; Index++)
+            {
+                Name = (char)(EEPROM.read(Address + Index));
+                if (Name != '\0')
+                {
+                    Serial.print(Name);
+                }
+            }
+            Serial.print(" : ");
+            if (EEPROM.read(Address + ProfileNameLength) <= WMC_CLI_PROFILE_LOCS)
+            {
+                Serial.print(EEPROM.read(Address + ProfileNameLength));
+                Serial.println(" locs");
+            }
+            else
+            {
+                Serial.println("invalid");
+            }
+        }
+    }
+}
+#endif
+
+#if (WMC_CLI_MODULE_PROFILE == 1) || (WMC_CLI_MODULE_UNDO == 1)
+/***********************************************************************************************************************
+ * Each record contains the address (big endian), the functions and the name of a loc.
+ */
+void WmcCli::RosterStore(uint16_t Address)
+{
+    uint16_t Index;
+    uint8_t Byte;
+    LocLibData* Data;
+
+    for (Index = 0; Index < m_locLib.GetNumberOfLocs(); Index++)
+    {
+        Data = m_locLib.LocGetAllDataByIndex(Index);
+        EEPROM.write(Address, (uint8_t)(Data->Addres >> 8));
+        EEPROM.write(Address + 1, (uint8_t)(Data->Addres));
+        for (Byte = 0; Byte < 5; Byte++)
+        {
+            EEPROM.write(Address + 2 + Byte, Data->FunctionAssignment[Byte]);
+        }
+        for (Byte = 0; Byte < sizeof(LocLibData::Name); Byte++)
+        {
+            EEPROM.write(Address + 7 + Byte, (uint8_t)(Data->Name[Byte]));
+        }
+        Address += ProfileRecordSize;
+    }
+}
+
+/***********************************************************************************************************************
+ * A record has a valid address and functions and its address is not used by an earlier record.
+ */
+bool WmcCli::RosterRecordsValid(uint16_t Address, uint8_t NumberOfLocs)
+{
+    uint16_t Record = Address;
+    uint8_t Index;
+    uint8_t Byte;
+    uint16_t LocAddress;
+    bool Result = (NumberOfLocs <= WMC_CLI_PROFILE_LOCS);
+
+    for (Index = 0; (Index < NumberOfLocs) && (Result == true); Index++)
+    {
+        LocAddress = ((uint16_t)(EEPROM.read(Record)) << 8) | EEPROM.read(Record + 1);
+        if ((LocAddress == 0) || (LocAddress > 9999) || (RosterRecordFind(Address, Index, LocAddress) == true))
+        {
+            Result = false;
+        }
+        for (Byte = 0; Byte < 5; Byte++)
+        {
+            if (EEPROM.read(Record + 2 + Byte) > 28)
+            {
+                Result = false;
+            }
+        }
+        Record += ProfileRecordSize;
+    }
+
+    return (Result);
+}
+
+/***********************************************************************************************************************
+ */
+bool WmcCli::RosterRecordFind(uint16_t Address, uint8_t NumberOfLocs, uint16_t LocAddress)
+{
+    uint8_t Index;
+    bool Result = false;
+
+    for (Index = 0; (Index < NumberOfLocs) && (Result == false); Index++)
+    {
+        if ((((uint16_t)(EEPROM.read(Address)) << 8) | EEPROM.read(Address + 1)) == LocAddress)
+        {
+            Result = true;
+        }
+        Address += ProfileRecordSize;
+    }
+
+    return (Result);
+}
+
+/***********************************************************************************************************************
+ * Locs which are not in the records are removed first, this includes a default loc of the loc lib. The other locs
+ * are changed or added, followed by one sort, index rebuild and checksum update.
+ */
+bool WmcCli::RosterLoad(uint16_t Address, uint8_t NumberOfLocs)
+{
+    uint16_t Index;
+    uint8_t Byte;
+    uint16_t LocAddress;
+    uint8_t Functions[5];
+    char Name[sizeof(LocLibData::Name)];
+    bool Result = true;
+
+    Index = m_locLib.GetNumberOfLocs();
+    while (Index > 0)
+    {
+        Index--;
+        LocAddress = m_locLib.LocGetAllDataByIndex(Index)->Addres;
+        if (RosterRecordFind(Address, NumberOfLocs, LocAddress) == false)
+        {
+            m_locLib.RemoveLoc(LocAddress);
+        }
+    }
+
+    for (Index = 0; (Index < NumberOfLocs) && (Result == true); Index++)
+    {
+        LocAddress = ((uint16_t)(EEPROM.read(Address)) << 8) | EEPROM.read(Address + 1);
+        for (Byte = 0; Byte < 5; Byte++)
+        {
+            Functions[Byte] = EEPROM.read(Address + 2 + Byte);
+        }
+        for (Byte = 0; Byte < sizeof(Name); Byte++)
+        {
+            Name[Byte] = (char)(EEPROM.read(Address + 7 + Byte));
+        }
+        Name[sizeof(Name) - 1] = '\0';
+
+        if (m_locLib.CheckLoc(LocAddress) == 255)
+        {
+            Result = m_locLib.StoreLoc(LocAddress, Functions, NULL, LocLib::storeAdd);
+        }
+        else
+        {
+            Result = m_locLib.StoreLoc(LocAddress, Functions, NULL, LocLib::storeChange);
+        }
+        if (Result == true)
+        {
+            m_locLib.StoreLoc(LocAddress, NULL, Name, LocLib::storeChange);
+        }
+        Address += ProfileRecordSize;
+    }
+
+    m_locLib.LocBubbleSort();
+    LocIndexInvalidate();
+    RosterChecksumCalculate();
+
+    return (Result);
+}
+#endif
+
+/***********************************************************************************************************************
+ * The journal is a ring of records, all records of one command line form a group, marked in the first record. A
+ * group larger than the journal cannot be reverted, the journal is cleared in that case. A clear is one record, the
+ * locs are kept in the snapshot area which holds the roster of the last clear. Each record is committed when it is
+ * finished, so after a reset the journal covers the changed roster.
+ */
+void WmcCli::UndoRecord(uint8_t Op, uint16_t Address, LocLibData* DataPtr)
+{
+#if WMC_CLI_MODULE_UNDO == 1
+    uint8_t Head;
+    uint8_t Count;
+    uint16_t RecordAddress;
+    uint8_t Index;
+    bool Store = (m_CliEepValid == true);
+
+    UndoHeaderGet(&Head, &Count);
+
+    if ((Store == true) && (Op == undoOpClear))
+    {
+        Store = UndoSnapshotSave(&Address);
+        if (Store == false)
+        {
+            Serial.println("Too many locs for the undo snapshot, undo not possible.");
+            Count = 0;
+        }
+    }
+
+    if ((Store == true) && (m_UndoGroupSize < WMC_CLI_UNDO_RECORDS))
+    {
+        if (DataPtr != NULL)
+        {
+            Address = DataPtr->Addres;
+        }
+
+        RecordAddress = UndoEepAddress + 2 + (Head * UndoRecordSize);
+        EEPROM.write(RecordAddress, (m_UndoGroupSize == 0) ? (Op | UndoGroupStart) : Op);
+        EEPROM.write(RecordAddress + 1, (uint8_t)(Address >> 8));
+        EEPROM.write(RecordAddress + 2, (uint8_t)(Address));
+        for (Index = 0; Index < (UndoRecordSize - 3); Index++)
+        {
+            if (DataPtr == NULL)
+            {
+                EEPROM.write(RecordAddress + 3 + Index, 0);
+            }
+            else if (Index < 5)
+            {
+                EEPROM.write(RecordAddress + 3 + Index, DataPtr->FunctionAssignment[Index]);
+            }
+            else
+            {
+                EEPROM.write(RecordAddress + 3 + Index, (uint8_t)(DataPtr->Name[Index - 5]));
+            }
+        }
+
+        Head = (Head + 1) % WMC_CLI_UNDO_RECORDS;
+        if (Count < WMC_CLI_UNDO_RECORDS)
+        {
+            Count++;
+        }
+        m_UndoGroupSize++;
+    }
+    else if ((Store == true) && (m_UndoGroupSize == WMC_CLI_UNDO_RECORDS))
+    {
+        /* The first record of the group is overwritten now. */
+        Serial.println("Command too large for the undo journal, undo not possible.");
+        Count = 0;
+        m_UndoGroupSize++;
+    }
+
+    if (m_CliEepValid == true)
+    {
+        EEPROM.write(UndoEepAddress, Head);
+        EEPROM.write(UndoEepAddress + 1, Count);
+        EepCommit();
+    }
+#else
+    (void)(Op);
+    (void)(Address);
+    (void)(DataPtr);
+#endif
+}
+
+#if WMC_CLI_MODULE_UNDO == 1
+/***********************************************************************************************************************
+ */
+void WmcCli::UndoCommand(void)
+{
+    uint16_t NumberOfCommands = 1;
+    uint16_t Reverted         = 0;
+
+    if (m_bufferRx[strlen(Undo)] == ' ')
+    {
+        NumberOfCommands = atoi(&m_bufferRx[strlen(Undo) + 1]);
+    }
+
+    while ((Reverted < NumberOfCommands) && (UndoGroup() == true))
+    {
+        Reverted++;
+    }
+
+    if (Reverted > 0)
+    {
+        m_locLib.LocBubbleSort();
+        LocIndexInvalidate();
+        RosterChecksumCalculate();
+        ChangeSet(cliChangeRoster);
+    }
+
+    Serial.print(Reverted);
+    Serial.println(" commands reverted.");
+}
+
+/***********************************************************************************************************************
+ * The records of the last group are reverted last record first, a clear restores the roster from the snapshot.
+ */
+bool WmcCli::UndoGroup(void)
+{
+    uint8_t Head;
+    uint8_t Count;
+    uint8_t Size = 0;
+    uint8_t Record;
+    uint8_t Op;
+    uint8_t Index;
+    uint16_t RecordAddress;
+    uint16_t Address;
+    uint8_t Functions[5];
+    char Name[sizeof(LocLibData::Name)];
+    bool Result = false;
+
+    UndoHeaderGet(&Head, &Count);
+
+    /* Find start of the last group, the start of the oldest group may be overwritten already. */
+    while ((Size < Count) && (Result == false))
+    {
+        Size++;
+        Record = (Head + WMC_CLI_UNDO_RECORDS - Size) % WMC_CLI_UNDO_RECORDS;
+        if ((EEPROM.read(UndoEepAddress + 2 + (Record * UndoRecordSize)) & UndoGroupStart) != 0)
+        {
+            Result = true;
+        }
+    }
+
+    for (Index = 1; (Index <= Size) && (Result == true); Index++)
+    {
+        Record        = (Head + WMC_CLI_UNDO_RECORDS - Index) % WMC_CLI_UNDO_RECORDS;
+        RecordAddress = UndoEepAddress + 2 + (Record * UndoRecordSize);
+        Op            = EEPROM.read(RecordAddress) & ~UndoGroupStart;
+        Address       = ((uint16_t)(EEPROM.read(RecordAddress + 1)) << 8) | EEPROM.read(RecordAddress + 2);
+
+        if (Op == undoOpAdd)
+        {
+            m_locLib.RemoveLoc(Address);
+        }
+        else if (Op == undoOpClear)
+        {
+            Result = UndoSnapshotRestore(Address);
+            if (Result == false)
+            {
+                /* Older commands cannot be reverted without the roster of this clear. */
+                Serial.println("Roster of the clear is no longer available, undo not possible.");
+                UndoClear();
+                EepCommit();
+            }
+        }
+        else if (Address != 0)
+        {
+            for (Record = 0; Record < 5; Record++)
+            {
+                Functions[Record] = EEPROM.read(RecordAddress + 3 + Record);
+            }
+            for (Record = 0; Record < sizeof(Name); Record++)
+            {
+                Name[Record] = (char)(EEPROM.read(RecordAddress + 8 + Record));
+            }
+            Name[sizeof(Name) - 1] = '\0';
+
+            if (m_locLib.CheckLoc(Address) == 255)
+            {
+                m_locLib.StoreLoc(Address, Functions, NULL, LocLib::storeAdd);
+            }
+            else
+            {
+                m_locLib.StoreLoc(Address, Functions, NULL, LocLib::storeChange);
+            }
+            m_locLib.StoreLoc(Address, NULL, Name, LocLib::storeChange);
+        }
+    }
+
+    if (Result == true)
+    {
+        EEPROM.write(UndoEepAddress, (Head + WMC_CLI_UNDO_RECORDS - Size) % WMC_CLI_UNDO_RECORDS);
+        EEPROM.write(UndoEepAddress + 1, Count - Size);
+        EepCommit();
+    }
+
+    return (Result);
+}
+
+/***********************************************************************************************************************
+ */
+void WmcCli::UndoHistory(void)
+{
+    uint8_t Head;
+    uint8_t Count;
+    uint8_t Index;
+    uint8_t Record;
+    uint8_t Op;
+    uint8_t NumberOfRecords = 0;
+    uint16_t Command        = 0;
+    uint16_t RecordAddress;
+    uint16_t Address;
+    const char* OpNames[] = { "", "add", "del", "change", "name", "clear" };
+
+    UndoHeaderGet(&Head, &Count);
+
+    for (Index = 1; Index <= Count; Index++)
+    {
+        Record        = (Head + WMC_CLI_UNDO_RECORDS - Index) % WMC_CLI_UNDO_RECORDS;
+        RecordAddress = UndoEepAddress + 2 + (Record * UndoRecordSize);
+        Op            = EEPROM.read(RecordAddress);
+        Address       = ((uint16_t)(EEPROM.read(RecordAddress + 1)) << 8) | EEPROM.read(RecordAddress + 2);
+        NumberOfRecords++;
+
+        if ((Op & UndoGroupStart) != 0)
+        {
+            Op &= ~UndoGroupStart;
+            Command++;
+            Serial.print(Command);
+            Serial.print(" : ");
+            Serial.print(OpNames[(Op <= undoOpClear) ? Op : 0]);
+            if (Op == undoOpClear)
+            {
+                /* The locs of a clear are in the snapshot. */
+                NumberOfRecords = 0;
+                if (UndoSnapshotTagGet() == Address)
+                {
+                    NumberOfRecords = EEPROM.read(UndoSnapshotEepAddress + 2);
+                }
+            }
+            else
+            {
+                Serial.print(" ");
+                Serial.print(Address);
+            }
+            if (NumberOfRecords > 1)
+            {
+                Serial.print(", ");
+                Serial.print(NumberOfRecords);
+                Serial.print(" locs");
+            }
+            Serial.println();
+            NumberOfRecords = 0;
+        }
+    }
+
+    if (Command == 0)
+    {
+        Serial.println("No commands to undo.");
+    }
+}
+
+/***********************************************************************************************************************
+ */
+void WmcCli::UndoClear(void)
+{
+    EEPROM.write(UndoEepAddress, 0);
+    EEPROM.write(UndoEepAddress + 1, 0);
+}
+
+/***********************************************************************************************************************
+ * An erased or corrupt header clears the journal.
+ */
+bool WmcCli::UndoHeaderGet(uint8_t* HeadPtr, uint8_t* CountPtr)
+{
+    bool Result = true;
+
+    *HeadPtr  = EEPROM.read(UndoEepAddress);
+    *CountPtr = EEPROM.read(UndoEepAddress + 1);
+
+    if ((*HeadPtr >= WMC_CLI_UNDO_RECORDS) || (*CountPtr > WMC_CLI_UNDO_RECORDS))
+    {
+        UndoClear();
+        *HeadPtr  = 0;
+        *CountPtr = 0;
+        Result    = false;
+    }
+
+    return (Result);
+}
+
+/***********************************************************************************************************************
+ */
+uint16_t WmcCli::UndoSnapshotTagGet(void)
+{
+    return (((uint16_t)(EEPROM.read(UndoSnapshotEepAddress)) << 8) | EEPROM.read(UndoSnapshotEepAddress + 1));
+}
+
+/***********************************************************************************************************************
+ * The snapshot contains a tag (big endian), the number of locs and the loc records in the profile format. Each clear
+ * gets a new tag, so the record of an older clear no longer matches the snapshot.
+ */
+bool WmcCli::UndoSnapshotSave(uint16_t* TagPtr)
+{
+    uint16_t NumberOfLocs = m_locLib.GetNumberOfLocs();
+    bool Result           = false;
+
+    if (NumberOfLocs <= WMC_CLI_PROFILE_LOCS)
+    {
+        *TagPtr = UndoSnapshotTagGet() + 1;
+        EEPROM.write(UndoSnapshotEepAddress, (uint8_t)(*TagPtr >> 8));
+        EEPROM.write(UndoSnapshotEepAddress + 1, (uint8_t)(*TagPtr));
+        EEPROM.write(UndoSnapshotEepAddress + 2, (uint8_t)(NumberOfLocs));
+        RosterStore(UndoSnapshotEepAddress + 3);
+        Result = true;
+    }
+
+    return (Result);
+}
+
+/***********************************************************************************************************************
+ */
+bool WmcCli::UndoSnapshotRestore(uint16_t Tag)
+{
+    uint8_t NumberOfLocs = EEPROM.read(UndoSnapshotEepAddress + 2);
+    bool Result          = false;
+
+    if ((UndoSnapshotTagGet() == Tag) && (RosterRecordsValid(UndoSnapshotEepAddress + 3, NumberOfLocs) == true))
+    {
+        Result = RosterLoad(UndoSnapshotEepAddress + 3, NumberOfLocs);
+    }
+
+    return (Result);
+}
+#endif
+
+/***********************************************************************************************************************
+ */
+void WmcCli::EepCommit(void)
+{
+    Trace(traceEepCommit, 0);
+#if APP_CFG_UC == APP_CFG_UC_ESP8266
+    EEPROM.commit();
+#endif
+}
+
+/***********************************************************************************************************************
+ */
+bool WmcCli::CliEepAvailable(void)
+{
+    if (m_CliEepValid == false)
+    {
+        Serial.println("Command not available, the cli EEPROM area does not fit in the EEPROM.");
+    }
+
+    return (m_CliEepValid);
+}
+
+/***********************************************************************************************************************
+ */
+void WmcCli::Trace(uint8_t Id, uint16_t Data)
+{
+#if WMC_CLI_MODULE_TRACE == 1
+    m_Trace[m_TraceIndex].Time = micros();
+    m_Trace[m_TraceIndex].Id   = Id;
+    m_Trace[m_TraceIndex].Data = Data;
+    m_TraceIndex               = (m_TraceIndex + 1) & (WMC_CLI_TRACE_SIZE - 1);
+
+    if (m_TraceNumberOfEntries < WMC_CLI_TRACE_SIZE)
+    {
+        m_TraceNumberOfEntries++;
+    }
+#else
+    (void)(Id);
+    (void)(Data);
+#endif
+}
+
+#if APP_CFG_UC == APP_CFG_UC_ESP8266
+/***********************************************************************************************************************
+ * Calibration starts with the reference value (no button pressed) followed by button 0..5. Each step is measured when
+ * enter is received, so the operator can hold the button while pressing enter.
+ */
+void WmcCli::CalibrateStep(void)
+{
+    uint8_t Index;
+
+    if (strncmp(m_bufferRx, "abort", 5) == 0)
+    {
+        m_CalibrateStep = 0;
+        Serial.println("Calibration aborted, stored values unchanged.");
+    }
+    else if (m_bufferRx[0] != '\0')
+    {
+        CalibratePrompt();
+    }
+    else
+    {
+        /* Reference is stored as last value. */
+        Index = (m_CalibrateStep == 1) ? 6 : m_CalibrateStep - 2;
+        if (CalibrateMeasure(&m_Scratch.CalibrateValues[Index]) == true)
+        {
+            Serial.print("Value ");
+            Serial.println(m_Scratch.CalibrateValues[Index]);
+
+            m_CalibrateStep++;
+            if (m_CalibrateStep > 7)
+            {
+                m_CalibrateStep = 0;
+                CalibrateStore();
+            }
+            else
+            {
+                CalibratePrompt();
+            }
+        }
+        else
+        {
+            Serial.println("Value not stable, measure again.");
+            CalibratePrompt();
+        }
+    }
+}
+
+/***********************************************************************************************************************
+ */
+void WmcCli::CalibratePrompt(void)
+{
+    if (m_CalibrateStep == 1)
+    {
+        Serial.println("Release all buttons and press enter.");
+    }
+    else
+    {
+        Serial.print("Hold button ");
+        Serial.print(m_CalibrateStep - 2);
+        Serial.println(" and press enter.");
+    }
+}
+
+/***********************************************************************************************************************
+ * The ADC is oversampled, the median is used as value and the spread of the middle half of the samples must be small
+ * so bouncing or a partly pressed button is rejected.
+ */
+bool WmcCli::CalibrateMeasure(uint16_t* ValuePtr)
+{
+    uint16_t Samples[CalibrateSamples];
+    uint16_t Sample;
+    uint8_t Index;
+    uint8_t Sorted;
+
+    for (Index = 0; Index < CalibrateSamples; Index++)
+    {
+        Sample = analogRead(A0);
+        delay(2);
+
+        /* Insertion sort while sampling. */
+        for (Sorted = Index; (Sorted > 0) && (Samples[Sorted - 1] > Sample); Sorted--)
+        {
+            Samples[Sorted] = Samples[Sorted - 1];
+        }
+        Samples[Sorted] = Sample;
+    }
+
+    *ValuePtr = Samples[CalibrateSamples / 2];
+
+    return ((Samples[(CalibrateSamples * 3) / 4] - Samples[CalibrateSamples / 4]) <= CalibrateSpreadLimit);
+}
+
+/***********************************************************************************************************************
+ * The application detects a button by the nearest stored value, so the threshold halfway between two values must
+ * have a margin to both values.
+ */
+void WmcCli::CalibrateStore(void)
+{
+    uint8_t Index;
+    uint8_t Compare;
+    uint16_t Distance;
+    uint16_t DistanceMin = 0xFFFF;
+    bool Result          = true;
+
+    for (Index = 0; Index < 7; Index++)
+    {
+        for (Compare = Index + 1; Compare < 7; Compare++)
+        {
+            Distance = (m_Scratch.CalibrateValues[Index] > m_Scratch.CalibrateValues[Compare])
+                ? m_Scratch.CalibrateValues[Index] - m_Scratch.CalibrateValues[Compare]
+                : m_Scratch.CalibrateValues[Compare] - m_Scratch.CalibrateValues[Index];
+            if (Distance < (2 * CalibrateMargin))
+            {
+                Serial.print("Values ");
+                Serial.print(Index);
+                Serial.print(" and ");
+                Serial.print(Compare);
+                Serial.println(" too close.");
+                Result = false;
+            }
+            else if (Distance < DistanceMin)
+            {
+                DistanceMin = Distance;
+            }
+        }
+    }
+
+    if (Result == true)
+    {
+        for (Index = 0; Index < 7; Index++)
+        {
+            EEPROM.write(
+                EepCfg::ButtonAdcValuesAddress + (Index * 2), (uint8_t)(m_Scratch.CalibrateValues[Index] >> 8));
+            EEPROM.write(EepCfg::ButtonAdcValuesAddress + (Index * 2) + 1, (uint8_t)(m_Scratch.CalibrateValues[Index]));
+        }
+        EEPROM.write(EepCfg::ButtonAdcValuesAddressValid, 1);
+        EepCommit();
+        SettingsChecksumUpdate();
+        ChangeSet(cliChangeAdc);
+        Serial.print("Button ADC values stored, threshold margin ");
+        Serial.println(DistanceMin / 2);
+    }
+    else
+    {
+        Serial.println("Calibration not stored, check the buttons and calibrate again.");
+    }
+}
+#endif
+
+#if (APP_CFG_UC == APP_CFG_UC_ESP8266) && (WMC_CLI_MODULE_DIAGNOSTICS == 1)
+/***********************************************************************************************************************
+ */
+void WmcCli::PrintButtonAdcData(void)
+{
+    uint8_t AdcValid;
+    uint8_t Index     = 0;
+    uint16_t AdcValue = 0;
+
+    AdcValid = EEPROM.read(EepCfg::ButtonAdcValuesAddressValid);
+
+    if (AdcValid == 1)
+    {
+        for (Index = 0; Index < 7; Index++)
+        {
+            AdcValue = (uint16_t)(EEPROM.read(EepCfg::ButtonAdcValuesAddress + (Index * 2))) << 8;
+            AdcValue |= (uint16_t)(EEPROM.read(EepCfg::ButtonAdcValuesAddress + (Index * 2) + 1));
+            if (Index <= 5)
+            {
+                Serial.print("Button    : ");
+                Serial.print(Index);
+                Serial.print(" : ");
+            }
+            else
+            {
+                Serial.print("Reference     : ");
+            }
+            Serial.println(AdcValue);
+        }
+    }
+    else
+    {
+        Serial.println("Button ADC data not valid");
+    }
+}
+
+#endif
+
+/***********************************************************************************************************************
+ */
+void WmcCli::DumpData(void)
+{
+    uint16_t Index        = 0;
+    uint8_t FunctionIndex = 0;
+    LocLibData* Data      = NULL;
+    char Name[WMC_CLI_NAME_LENGTH + 1];
+
+    // Loc address and functions
+    while (Index < m_locLib.GetNumberOfLocs())
+    {
+        Data = m_locLib.LocGetAllDataByIndex(Index);
+        Serial.print(LocAdd);
+        Serial.println(Data->Addres);
+
+        for (FunctionIndex = 0; FunctionIndex < 5; FunctionIndex++)
+        {
+            Serial.print(LocChange);
+            Serial.print(Data->Addres);
+            Serial.print(" ");
+            Serial.print(FunctionIndex);
+            Serial.print(" ");
+            Serial.println(Data->FunctionAssignment[FunctionIndex]);
+        }
+
+        Index++;
+    }
+
+    // Locnames
+    Index = 0;
+    while (Index < m_locLib.GetNumberOfLocs())
+    {
+        Data = m_locLib.LocGetAllDataByIndex(Index);
+        if (NameGet(Data, Name) > 0)
+        {
+            Serial.print(LocName);
+            Serial.print(Data->Addres);
+            Serial.print(" ");
+            Serial.println(Name);
+        }
+        Index++;
+    }
+
+    /* Dump the AC option. */
+    Serial.print(Ac);
+    Serial.print(" ");
+    Serial.println(m_LocStorage.AcOptionGet());
+
+    /* Dump the emergency option. */
+    Serial.print(Emergency);
+    Serial.println(m_LocStorage.EmergencyOptionGet());
+
+#if APP_CFG_UC == APP_CFG_UC_ESP8266
+    ShowNetworkSettings();
+#endif
+}
+
+/***********************************************************************************************************************
+ */
+void WmcCli::LocIndexInvalidate(void)
+{
+#if WMC_CLI_LOC_INDEX_SIZE > 0
+    m_LocIndexValid = false;
+#endif
+    m_RosterGeneration++;
+}
+
+/***********************************************************************************************************************
+ * Open addressing hash with linear probing, each entry contains the loc table index + 1 (0 is a free entry). The
+ * address itself is not stored, it is compared with the address in the loc table. A single added or deleted loc
+ * updates the index, commands changing many locs invalidate it so it is rebuild once on the next search.
+ */
+uint16_t WmcCli::LocIndexFind(uint16_t Address)
+{
+    uint16_t Entry;
+    uint16_t Result = LocIndexNotFound;
+#if WMC_CLI_LOC_INDEX_SIZE > 0
+    uint16_t Probe;
+
+    if ((m_LocIndexValid == false) || (m_LocIndexNumberOfLocs != m_locLib.GetNumberOfLocs()))
+    {
+        m_LocIndexValid = LocIndexBuild();
+    }
+
+    if (m_LocIndexValid == true)
+    {
+        Entry = LocIndexHash(Address);
+
+        for (Probe = 0; (Probe < WMC_CLI_LOC_INDEX_SIZE) && (m_LocIndex[Entry] != 0); Probe++)
+        {
+            if (m_locLib.LocGetAllDataByIndex(m_LocIndex[Entry] - 1)->Addres == Address)
+            {
+                Result = m_LocIndex[Entry] - 1;
+                break;
+            }
+
+            Entry = (Entry + 1) & LocIndexMask;
+        }
+    }
+    else
+#endif
+    {
+        /* No index or too many locs for the index, use the search of the loc lib. */
+        Entry = m_locLib.CheckLoc(Address);
+        if (Entry != 255)
+        {
+            Result = Entry;
+        }
+    }
+
+    return (Result);
+}
+
+#if WMC_CLI_LOC_INDEX_SIZE > 0
+/***********************************************************************************************************************
+ */
+bool WmcCli::LocIndexBuild(void)
+{
+    uint16_t Index = 0;
+    uint16_t Entry;
+    bool Result = false;
+
+    m_LocIndexNumberOfLocs = m_locLib.GetNumberOfLocs();
+
+    /* Keep at least one free entry so a search always ends. */
+    if (m_LocIndexNumberOfLocs < WMC_CLI_LOC_INDEX_SIZE)
+    {
+        memset(m_LocIndex, 0, sizeof(m_LocIndex));
+
+        while (Index < m_LocIndexNumberOfLocs)
+        {
+            Entry = LocIndexHash(m_locLib.LocGetAllDataByIndex(Index)->Addres);
+            while (m_LocIndex[Entry] != 0)
+            {
+                Entry = (Entry + 1) & LocIndexMask;
+            }
+
+            m_LocIndex[Entry] = Index + 1;
+            Index++;
+        }
+
+        Result = true;
+    }
+
+    return (Result);
+}
+
+/***********************************************************************************************************************
+ * Fibonacci hashing, the high bits of the 16 bit product are used as the low bits are poorly mixed for consecutive
+ * addresses.
+ */
+uint16_t WmcCli::LocIndexHash(uint16_t Address)
+{
+    return ((uint16_t)(((uint32_t)((uint16_t)(Address * 40503U)) * WMC_CLI_LOC_INDEX_SIZE) >> 16));
+}
+#endif
+
+/***********************************************************************************************************************
+ * Add a loc to the index after it is stored and the loc table is sorted. The locs behind the new loc moved one
+ * position in the loc table.
+ */
+void WmcCli::LocIndexInsert(uint16_t Address)
+{
+#if WMC_CLI_LOC_INDEX_SIZE > 0
+    uint16_t NumberOfLocs = m_locLib.GetNumberOfLocs();
+    uint16_t Low          = 0;
+    uint16_t High         = NumberOfLocs;
+    uint16_t Middle;
+    uint16_t Entry;
+#endif
+
+    m_RosterGeneration++;
+
+#if WMC_CLI_LOC_INDEX_SIZE > 0
+    /* Binary search of the position of the new loc in the sorted loc table. */
+    while (Low < High)
+    {
+        Middle = (Low + High) / 2;
+        if (m_locLib.LocGetAllDataByIndex(Middle)->Addres < Address)
+        {
+            Low = Middle + 1;
+        }
+        else
+        {
+            High = Middle;
+        }
+    }
+
+    if ((m_LocIndexValid == false) || (NumberOfLocs != (m_LocIndexNumberOfLocs + 1))
+        || (NumberOfLocs >= WMC_CLI_LOC_INDEX_SIZE) || (Low >= NumberOfLocs)
+        || (m_locLib.LocGetAllDataByIndex(Low)->Addres != Address))
+    {
+        m_LocIndexValid = false;
+    }
+    else
+    {
+        for (Entry = 0; Entry < WMC_CLI_LOC_INDEX_SIZE; Entry++)
+        {
+            if (m_LocIndex[Entry] > Low)
+            {
+                m_LocIndex[Entry]++;
+            }
+        }
+
+        Entry = LocIndexHash(Address);
+        while (m_LocIndex[Entry] != 0)
+        {
+            Entry = (Entry + 1) & LocIndexMask;
+        }
+
+        m_LocIndex[Entry]      = Low + 1;
+        m_LocIndexNumberOfLocs = NumberOfLocs;
+    }
+#else
+    (void)(Address);
+#endif
+}
+
+/***********************************************************************************************************************
+ * Remove a loc from the index after it is removed from the loc table, Index is its former position in the loc table.
+ * Entries behind the freed entry are moved back (backward shift deletion), so no search stops early at the freed
+ * entry.
+ */
+void WmcCli::LocIndexRemove(uint16_t Address, uint16_t Index)
+{
+#if WMC_CLI_LOC_INDEX_SIZE > 0
+    uint16_t Free = LocIndexHash(Address);
+    uint16_t Entry;
+    uint16_t Home;
+    uint16_t Probe;
+#endif
+
+    m_RosterGeneration++;
+
+#if WMC_CLI_LOC_INDEX_SIZE > 0
+    for (Probe = 0; (Probe < WMC_CLI_LOC_INDEX_SIZE) && (m_LocIndex[Free] != (Index + 1)); Probe++)
+    {
+        Free = (Free + 1) & LocIndexMask;
+    }
+
+    if ((m_LocIndexValid == false) || (Probe == WMC_CLI_LOC_INDEX_SIZE)
+        || (m_locLib.GetNumberOfLocs() != (m_LocIndexNumberOfLocs - 1)))
+    {
+        m_LocIndexValid = false;
+    }
+    else
+    {
+        m_LocIndex[Free] = 0;
+        for (Entry = 0; Entry < WMC_CLI_LOC_INDEX_SIZE; Entry++)
+        {
+            if (m_LocIndex[Entry] > (Index + 1))
+            {
+                m_LocIndex[Entry]--;
+            }
+        }
+
+        Entry = (Free + 1) & LocIndexMask;
+        while (m_LocIndex[Entry] != 0)
+        {
+            /* Move the entry to the free entry when the free entry is part of its probe sequence. */
+            Home = LocIndexHash(m_locLib.LocGetAllDataByIndex(m_LocIndex[Entry] - 1)->Addres);
+            if (((Entry - Home) & LocIndexMask) >= ((Entry - Free) & LocIndexMask))
+            {
+                m_LocIndex[Free]  = m_LocIndex[Entry];
+                m_LocIndex[Entry] = 0;
+                Free              = Entry;
+            }
+
+            Entry = (Entry + 1) & LocIndexMask;
+        }
+
+        m_LocIndexNumberOfLocs--;
+    }
+#else
+    (void)(Address);
+    (void)(Index);
+#endif
+}
+
+#if WMC_CLI_MODULE_SYNC == 1
+/***********************************************************************************************************************
+ * The hash of a loc is the CRC32 (as zlib crc32) of address (big endian), the five function assignments and the
+ * name without terminator. The root hash is the CRC32 of all loc hashes (big endian) in order of the sorted loc
+ * table, so a host can compare the root hash first and only check the individual locs when it differs.
+ */
+bool WmcCli::SyncCommand(void)
+{
+    uint16_t Index   = 0;
+    uint32_t Root    = 0xFFFFFFFF;
+    uint32_t Hash    = 0;
+    bool List        = false;
+    bool Result      = false;
+    LocLibData* Data = NULL;
+
+    if (strncmp(&m_bufferRx[strlen(Sync)], " loc ", 5) == 0)
+    {
+        Result = SyncLoc(&m_bufferRx[strlen(Sync) + 5]);
+    }
+    else
+    {
+        if (strncmp(&m_bufferRx[strlen(Sync)], " list", 5) == 0)
+        {
+            List = true;
+        }
+
+        while (Index < m_locLib.GetNumberOfLocs())
+        {
+            Data = m_locLib.LocGetAllDataByIndex(Index);
+            Hash = LocRecordHash(Data);
+
+            if (List == true)
+            {
+                Serial.print("loc ");
+                Serial.print(Data->Addres);
+                Serial.print(" ");
+                PrintHex32(Hash);
+                Serial.println();
+            }
+
+            Root = Crc32Update32(Root, Hash);
+            Index++;
+        }
+
+        Serial.print("root ");
+        Serial.print(m_locLib.GetNumberOfLocs());
+        Serial.print(" ");
+        PrintHex32(~Root);
+        Serial.println();
+    }
+
+    return (Result);
+}
+
+/***********************************************************************************************************************
+ */
+bool WmcCli::SyncLoc(char* DataPtr)
+{
+    uint8_t Functions[5];
+    uint8_t Index;
+    int Address;
+    int Function;
+    const char* NamePtr = "";
+    bool Result         = true;
+
+    /* Range check before the casts, else 257 would be stored as function 1. */
+    Address = atoi(DataPtr);
+
+    for (Index = 0; (Index < 5) && (Result == true); Index++)
+    {
+        DataPtr = strchr(DataPtr, ' ');
+        if (DataPtr != NULL)
+        {
+            DataPtr++;
+            Function = atoi(DataPtr);
+            if ((Function >= 0) && (Function <= 28))
+            {
+                Functions[Index] = (uint8_t)(Function);
+            }
+            else
+            {
+                Result = false;
+            }
+        }
+        else
+        {
+            Result = false;
+        }
+    }
+
+    if (Result == true)
+    {
+        /* Name is optional, no name removes the actual name. */
+        DataPtr = strchr(DataPtr, ' ');
+        if (DataPtr != NULL)
+        {
+            NamePtr = DataPtr + 1;
+        }
+    }
+
+    if ((Result == true) && (Address > 0) && (Address <= 9999))
+    {
+        LocChecksumToggle(Address);
+
+        if (LocIndexFind(Address) == LocIndexNotFound)
+        {
+            Result = m_locLib.StoreLoc(Address, Functions, NULL, LocLib::storeAdd);
+            if (Result == true)
+            {
+                UndoRecord(undoOpAdd, Address, NULL);
+                m_locLib.LocBubbleSort();
+                LocIndexInsert(Address);
+                ChangeSet(cliChangeRoster);
+            }
+        }
+        else
+        {
+            UndoRecord(undoOpChange, Address, m_locLib.LocGetAllDataByIndex(LocIndexFind(Address)));
+            Result = m_locLib.StoreLoc(Address, Functions, NULL, LocLib::storeChange);
+            if (Result == true)
+            {
+                ChangeSet(cliChangeLoc, Address);
+            }
+        }
+
+        if (Result == true)
+        {
+            m_locLib.StoreLoc(Address, NULL, (char*)(NamePtr), LocLib::storeChange);
+            NamePoolStore(Address, NamePtr);
+            LocChecksumToggle(Address);
+            Serial.print("loc ");
+            Serial.print(Address);
+            Serial.print(" ");
+            PrintHex32(LocRecordHash(m_locLib.LocGetAllDataByIndex(LocIndexFind(Address))));
+            Serial.println();
+        }
+        else
+        {
+            /* Nothing stored, restore the hash of the present loc. */
+            LocChecksumToggle(Address);
+            Serial.println("Sync loc failed, loc not stored!");
+        }
+    }
+    else
+    {
+        Result = false;
+        Serial.println("Sync loc command invalid.");
+    }
+
+    return (Result);
+}
+#endif
+
+/***********************************************************************************************************************
+ */
+uint32_t WmcCli::LocRecordHash(LocLibData* DataPtr)
+{
+    uint8_t Address[2];
+    uint32_t Crc = 0xFFFFFFFF;
+
+    Address[0] = (uint8_t)(DataPtr->Addres >> 8);
+    Address[1] = (uint8_t)(DataPtr->Addres);
+
+    Crc = Crc32Update(Crc, Address, sizeof(Address));
+    Crc = Crc32Update(Crc, DataPtr->FunctionAssignment, 5);
+    Crc = Crc32Update(Crc, (const uint8_t*)(DataPtr->Name), strlen(DataPtr->Name));
+
+    return (~Crc);
+}
+
+#if WMC_CLI_MODULE_DIAGNOSTICS == 1
+/***********************************************************************************************************************
+ * The loc table checksum is the XOR of all loc hashes, so it does not depend on the order of the locs and a changed
+ * loc is processed by removing the old and adding the new loc hash. The settings checksum is a CRC32 over the raw
+ * settings data and recalculated after each settings change.
+ */
+void WmcCli::ChecksumCommand(void)
+{
+    uint32_t Crc = 0xFFFFFFFF;
+
+    /* Locs may also be changed outside the cli, recalculate when the number of locs does not match. */
+    if ((strncmp(&m_bufferRx[strlen(Checksum)], " full", 5) == 0)
+        || (m_ChecksumNumberOfLocs != m_locLib.GetNumberOfLocs()))
+    {
+        RosterChecksumCalculate();
+        SettingsChecksumUpdate();
+    }
+
+    Crc = Crc32Update32(Crc, m_RosterChecksum);
+    Crc = Crc32Update32(Crc, m_SettingsChecksum);
+
+    Serial.print("checksum ");
+    PrintHex32(~Crc);
+    Serial.print(" locs ");
+    PrintHex32(m_RosterChecksum);
+    Serial.print(" settings ");
+    PrintHex32(m_SettingsChecksum);
+    Serial.println();
+}
+
+/***********************************************************************************************************************
+ * Each test is measured BenchSamples times, fast operations are repeated BenchOps times within one sample. The
+ * EEPROM write test writes the actual value back. The commit test inverts the spare last byte of the integrity table
+ * so each commit really writes the flash, the even number of samples restores the byte. The dispatch test runs the
+ * real command chain of Process with an empty line, which matches none of the commands.
+ */
+void WmcCli::BenchCommand(void)
+{
+    uint32_t Samples[BenchSamples];
+    uint32_t Results[benchCount][4];
+    uint32_t Start;
+    uint8_t Test;
+    uint8_t Index;
+    uint8_t Op;
+    uint8_t NumberOfSamples;
+    uint8_t OpsPerSample;
+    uint8_t Value;
+    volatile uint8_t Read;
+    char Output[56];
+    uint16_t NumberOfLocs   = m_locLib.GetNumberOfLocs();
+    const char* TestNames[] = { "eep read", "eep write", "eep commit", "serial tx byte", "checkloc", "loc index",
+        "loc data", "dispatch" };
+    const char* SerialPattern = "bench 0123456789abcdefghijklmn";
+
+    for (Test = benchEepRead; Test < benchCount; Test++)
+    {
+        NumberOfSamples = BenchSamples;
+        OpsPerSample    = BenchOps;
+
+        switch (Test)
+        {
+        case benchEepWrite: OpsPerSample = 1; break;
+        case benchEepCommit:
+            NumberOfSamples = 4;
+            OpsPerSample    = 1;
+            break;
+        case benchSerialTx:
+            NumberOfSamples = 8;
+            OpsPerSample    = strlen(SerialPattern) + 2;
+            break;
+        default: break;
+        }
+
+        for (Index = 0; Index < NumberOfSamples; Index++)
+        {
+            Start = micros();
+            switch (Test)
+            {
+            case benchEepRead:
+                for (Op = 0; Op < OpsPerSample; Op++)
+                {
+                    Read = EEPROM.read(IntegrityEepAddress + Op);
+                }
+                break;
+            case benchEepWrite:
+                Value = EEPROM.read(IntegrityEepAddress);
+                EEPROM.write(IntegrityEepAddress, Value);
+                break;
+            case benchEepCommit:
+                Value = EEPROM.read(IntegrityEepAddress + IntegrityTableSize - 1);
+                EEPROM.write(IntegrityEepAddress + IntegrityTableSize - 1, Value ^ 0xFF);
+                EepCommit();
+                break;
+            case benchSerialTx: Serial.println(SerialPattern); break;
+            case benchCheckLoc:
+                for (Op = 0; Op < OpsPerSample; Op++)
+                {
+                    if (NumberOfLocs > 0)
+                    {
+                        m_locLib.CheckLoc(m_locLib.LocGetAllDataByIndex((Index + Op) % NumberOfLocs)->Addres);
+                    }
+                    else
+                    {
+                        m_locLib.CheckLoc(Index + Op + 1);
+                    }
+                }
+                break;
+            case benchLocIndex:
+                for (Op = 0; Op < OpsPerSample; Op++)
+                {
+                    if (NumberOfLocs > 0)
+                    {
+                        LocIndexFind(m_locLib.LocGetAllDataByIndex((Index + Op) % NumberOfLocs)->Addres);
+                    }
+                    else
+                    {
+                        LocIndexFind(Index + Op + 1);
+                    }
+                }
+                break;
+            case benchLocData:
+                for (Op = 0; (Op < OpsPerSample) && (NumberOfLocs > 0); Op++)
+                {
+                    m_locLib.LocGetAllDataByIndex((Index + Op) % NumberOfLocs);
+                }
+                break;
+            case benchDispatch:
+                m_bufferRx[0] = '\0';
+                for (Op = 0; Op < OpsPerSample; Op++)
+                {
+                    Process();
+                }
+                break;
+            default: break;
+            }
+            Samples[Index] = micros() - Start;
+        }
+
+        BenchSummarize(Samples, NumberOfSamples, OpsPerSample, Results[Test]);
+    }
+
+    Serial.println("bench               ops/s    p50 ns    p90 ns    max ns");
+    for (Test = benchEepRead; Test < benchCount; Test++)
+    {
+        sprintf(Output, "%-15s%10lu%10lu%10lu%10lu", TestNames[Test], (unsigned long)(Results[Test][0]),
+            (unsigned long)(Results[Test][1]), (unsigned long)(Results[Test][2]), (unsigned long)(Results[Test][3]));
+        Serial.println(Output);
+    }
+
+    Serial.print("bench end, locs ");
+    Serial.println(NumberOfLocs);
+    (void)(Read);
+}
+
+/***********************************************************************************************************************
+ * Result: operations per second, median, 90th percentile and max duration of one operation in ns.
+ */
+void WmcCli::BenchSummarize(uint32_t* SamplesPtr, uint8_t NumberOfSamples, uint8_t OpsPerSample, uint32_t* ResultPtr)
+{
+    uint8_t Index;
+    uint8_t Sorted;
+    uint32_t Sample;
+    uint32_t Total = 0;
+
+    for (Index = 0; Index < NumberOfSamples; Index++)
+    {
+        Sample = SamplesPtr[Index];
+        Total += Sample;
+        for (Sorted = Index; (Sorted > 0) && (SamplesPtr[Sorted - 1] > Sample); Sorted--)
+        {
+            SamplesPtr[Sorted] = SamplesPtr[Sorted - 1];
+        }
+        SamplesPtr[Sorted] = Sample;
+    }
+
+    /* Avoid division by zero for operations faster than the timer resolution. */
+    if (Total == 0)
+    {
+        Total = 1;
+    }
+
+    ResultPtr[0] = (uint32_t)(((uint64_t)(NumberOfSamples) * OpsPerSample * 1000000) / Total);
+    ResultPtr[1] = (SamplesPtr[NumberOfSamples / 2] * 1000) / OpsPerSample;
+    ResultPtr[2] = (SamplesPtr[(NumberOfSamples * 9) / 10] * 1000) / OpsPerSample;
+    ResultPtr[3] = (SamplesPtr[NumberOfSamples - 1] * 1000) / OpsPerSample;
+}
+
+/***********************************************************************************************************************
+ * The read output consists of write commands, so a stored EEPROM image can be written back by sending it.
+ */
+void WmcCli::EepCommand(void)
+{
+    char* DataPtr = &m_bufferRx[strlen(Eep)];
+    char* Space;
+    uint16_t Address;
+    uint16_t Length;
+    uint16_t Index;
+    uint8_t Nibble;
+    uint8_t Byte = 0;
+    uint8_t Change;
+    uint8_t NetworkChange;
+    char Output[3];
+    bool Result = true;
+
+    if (strncmp(DataPtr, "read ", 5) == 0)
+    {
+        Address = atoi(&DataPtr[5]);
+        Space   = strchr(&DataPtr[5], ' ');
+        Length  = (Space != NULL) ? atoi(Space) : 1;
+
+        if (((uint32_t)(Address) + Length) > EEPROM.length())
+        {
+            Serial.println("Address range invalid.");
+        }
+        else
+        {
+            for (Index = 0; Index < Length; Index++)
+            {
+                if ((Index % EepBytesPerLine) == 0)
+                {
+                    Serial.print(Eep);
+                    Serial.print("write ");
+                    Serial.print(Address + Index);
+                    Serial.print(" ");
+                }
+
+                sprintf(Output, "%02X", EEPROM.read(Address + Index));
+                Serial.print(Output);
+
+                if (((Index % EepBytesPerLine) == (EepBytesPerLine - 1)) || (Index == (Length - 1)))
+                {
+                    Serial.println();
+                }
+            }
+        }
+    }
+    else if (strncmp(DataPtr, "write ", 6) == 0)
+    {
+        Address = atoi(&DataPtr[6]);
+        Space   = strchr(&DataPtr[6], ' ');
+        Length  = (Space != NULL) ? strlen(Space + 1) : 0;
+
+        /* Check hex data before writing anything. */
+        for (Index = 0; (Index < Length) && (Result == true); Index++)
+        {
+            Result = strchr("0123456789abcdefABCDEF", Space[1 + Index]) != NULL;
+        }
+
+        if ((Length == 0) || ((Length % 2) != 0) || (Result == false))
+        {
+            Serial.println("Hex data invalid.");
+        }
+        else if (EepWriteAllowed(Address, Length / 2, &Change, &NetworkChange) == false)
+        {
+            Serial.println("Address range not writable.");
+        }
+        else if (((Change == cliChangeAc) || (Change == cliChangeEmergency)) && (strcmp(&Space[1], "00") != 0)
+            && (strcmp(&Space[1], "01") != 0))
+        {
+            Serial.println("Option value invalid, must be 00 or 01.");
+        }
+        else
+        {
+            for (Index = 0; Index < Length; Index++)
+            {
+                Nibble = (uint8_t)(Space[1 + Index]);
+                Nibble = (Nibble <= '9') ? Nibble - '0' : (Nibble | 0x20) - 'a' + 10;
+                Byte   = (Byte << 4) | Nibble;
+                if ((Index % 2) != 0)
+                {
+                    /* The options are owned by the loc storage, which keeps its own copy like for set. */
+                    if (Change == cliChangeAc)
+                    {
+                        m_LocStorage.AcOptionSet(Byte);
+                    }
+                    else if (Change == cliChangeEmergency)
+                    {
+                        m_LocStorage.EmergencyOptionSet(Byte);
+                    }
+                    else
+                    {
+                        EEPROM.write(Address + (Index / 2), Byte);
+                    }
+                }
+            }
+            EepCommit();
+
+            /* Settings are reloaded and resealed with the cli event, like a changed setting. */
+            SettingsChecksumUpdate();
+#if APP_CFG_UC == APP_CFG_UC_ESP8266
+            if (NetworkChange != networkChangeNone)
+            {
+                NetworkChangeSet(NetworkChange);
+            }
+            else
+#endif
+            {
+                ChangeSet(Change);
+            }
+
+            Serial.print(Length / 2);
+            Serial.println(" bytes written.");
+        }
+    }
+    else
+    {
+        Serial.println("Eep command invalid.");
+    }
+}
+
+/***********************************************************************************************************************
+ * Writable are the settings of the settings table, the button ADC values and the macros, profiles and name pool of
+ * the cli, which are checked when they are used. The integrity table and the undo journal and snapshot are only
+ * written by the cli itself. The loc storage is not writable, it is also kept in RAM by the loc lib. The ac and
+ * emergency options are kept in RAM by the loc storage, the eep command writes them through the loc storage.
+ */
+bool WmcCli::EepWriteAllowed(uint16_t Address, uint16_t Length, uint8_t* ChangePtr, uint8_t* NetworkChangePtr)
+{
+    uint8_t Index;
+    uint32_t End = (uint32_t)(Address) + Length;
+    bool Result  = false;
+
+    *ChangePtr        = cliChangeNone;
+    *NetworkChangePtr = 0;
+
+    for (Index = 0; (Index < SettingsTableSize) && (Result == false); Index++)
+    {
+        if ((Address >= SettingsTable[Index].EepAddress)
+            && (End <= (uint32_t)(SettingsTable[Index].EepAddress) + SettingsTable[Index].Size))
+        {
+            *ChangePtr        = SettingsTable[Index].Event;
+            *NetworkChangePtr = SettingsTable[Index].Change;
+            Result            = true;
+        }
+    }
+
+#if APP_CFG_UC == APP_CFG_UC_ESP8266
+    if ((Address >= EepCfg::ButtonAdcValuesAddressValid) && (End <= EepCfg::ButtonAdcValuesAddressValid + 1U))
+    {
+        *ChangePtr = cliChangeAdc;
+        Result     = true;
+    }
+    else if ((Address >= EepCfg::ButtonAdcValuesAddress) && (End <= EepCfg::ButtonAdcValuesAddress + 14U))
+    {
+        *ChangePtr = cliChangeAdc;
+        Result     = true;
+    }
+#endif
+
+    if (End <= EEPROM.length())
+    {
+        if ((Address >= MacroEepAddress) && (End <= IntegrityEepAddress))
+        {
+            Result = true;
+        }
+        else if ((Address >= ProfileEepAddress) && (End <= UndoEepAddress))
+        {
+            Result = true;
+        }
+        else if ((Address >= NamePoolEepAddress) && (End <= CliEepEnd))
+        {
+            Result = true;
+        }
+    }
+
+    return (Result);
+}
+#endif
+
+#if WMC_CLI_MODULE_TRACE == 1
+/***********************************************************************************************************************
+ * The dump shows the oldest entry first, one entry per line: time in us, event and data.
+ */
+void WmcCli::TraceCommand(void)
+{
+    uint8_t Index;
+    uint8_t Entry;
+    const char* TraceNames[] = { "cmd", "end", "commit", "event", "overflow" };
+    char Output[34];
+
+    if (strncmp(&m_bufferRx[strlen(TraceCmd)], "dump", 4) == 0)
+    {
+        Serial.print("trace ");
+        Serial.println(m_TraceNumberOfEntries);
+
+        Entry = (m_TraceIndex - m_TraceNumberOfEntries) & (WMC_CLI_TRACE_SIZE - 1);
+        for (Index = 0; Index < m_TraceNumberOfEntries; Index++)
+        {
+            if (m_Trace[Entry].Id == traceCommandStart)
+            {
+                sprintf(Output, "%10lu %-8s %c%c", (unsigned long)(m_Trace[Entry].Time), TraceNames[m_Trace[Entry].Id],
+                    (char)(m_Trace[Entry].Data >> 8), (char)(m_Trace[Entry].Data));
+            }
+            else
+            {
+                sprintf(Output, "%10lu %-8s %u", (unsigned long)(m_Trace[Entry].Time), TraceNames[m_Trace[Entry].Id],
+                    m_Trace[Entry].Data);
+            }
+            Serial.println(Output);
+            Entry = (Entry + 1) & (WMC_CLI_TRACE_SIZE - 1);
+        }
+    }
+    else if (strncmp(&m_bufferRx[strlen(TraceCmd)], "clear", 5) == 0)
+    {
+        m_TraceIndex           = 0;
+        m_TraceNumberOfEntries = 0;
+        Serial.println("Trace cleared.");
+    }
+    else
+    {
+        Serial.println("Trace command invalid.");
+    }
+}
+#endif
+
+/***********************************************************************************************************************
+ */
+void WmcCli::RosterChecksumCalculate(void)
+{
+    uint16_t Index = 0;
+
+    m_RosterChecksum = 0;
+
+    while (Index < m_locLib.GetNumberOfLocs())
+    {
+        m_RosterChecksum ^= LocRecordHash(m_locLib.LocGetAllDataByIndex(Index));
+        Index++;
+    }
+
+    m_ChecksumNumberOfLocs = m_locLib.GetNumberOfLocs();
+}
+
+/***********************************************************************************************************************
+ */
+void WmcCli::LocChecksumToggle(uint16_t Address)
+{
+    uint16_t Index = LocIndexFind(Address);
+
+    if (Index != LocIndexNotFound)
+    {
+        m_RosterChecksum ^= LocRecordHash(m_locLib.LocGetAllDataByIndex(Index));
+    }
+
+    m_ChecksumNumberOfLocs = m_locLib.GetNumberOfLocs();
+}
+
+/***********************************************************************************************************************
+ */
+void WmcCli::SettingsChecksumUpdate(void)
+{
+    uint8_t Region;
+    uint32_t Crc = 0xFFFFFFFF;
+
+    for (Region = regionOptions; Region < regionCount; Region++)
+    {
+        Crc = Crc32Update32(Crc, RegionCrc(Region));
+    }
+#if APP_CFG_UC == APP_CFG_UC_STM32
+    Crc = Crc32Update32(Crc, m_LocStorage.XpNetAddressGet());
+#endif
+
+    m_SettingsChecksum = ~Crc;
+}
+
+/***********************************************************************************************************************
+ * Each data region has a version and CRC32 entry in the EEPROM area of the cli. A region with another version (new
+ * device or changed layout) is checked for invalid values and sealed. The cli seals a region after each command which
+ * changed it and the application after its own writes, so a wrong CRC32 is corruption. Invalid values of a corrupt
+ * region are restored at once so the cached values can be used unchecked, the region stays reported as corrupt until
+ * a repair accepts the remaining data.
+ */
+void WmcCli::IntegrityCheck(bool Print, bool Repair)
+{
+    uint8_t Region;
+    uint16_t Address;
+    uint32_t Crc;
+    bool Seal                    = false;
+    const char* RegionNames[]    = { "locs", "options", "network", "buttons" };
+    const uint8_t RegionChange[] = { cliChangeRoster, cliChangeAc | cliChangeEmergency, cliChangeNetwork,
+        cliChangeAdc };
+
+    for (Region = regionRoster; Region < regionCount; Region++)
+    {
+        Address = IntegrityEepAddress + (Region * 5);
+        Crc     = (uint32_t)(EEPROM.read(Address + 1)) << 24;
+        Crc |= (uint32_t)(EEPROM.read(Address + 2)) << 16;
+        Crc |= (uint32_t)(EEPROM.read(Address + 3)) << 8;
+        Crc |= (uint32_t)(EEPROM.read(Address + 4));
+
+        if (EEPROM.read(Address) != IntegrityVersion)
+        {
+            RegionRepair(Region);
+            RegionSeal(Region);
+            Seal = true;
+        }
+        else if (Crc != RegionCrc(Region))
+        {
+            m_RegionCorrupt |= (1 << Region);
+            if (RegionValid(Region) == false)
+            {
+                RegionRepair(Region);
+            }
+        }
+        else
+        {
+            m_RegionCorrupt &= ~(1 << Region);
+        }
+
+        if (((m_RegionCorrupt & (1 << Region)) != 0) && (Repair == true))
+        {
+            RegionRepair(Region);
+            RegionSeal(Region);
+            m_RegionCorrupt &= ~(1 << Region);
+            Seal = true;
+            ChangeSet(RegionChange[Region]);
+            Serial.print(RegionNames[Region]);
+            Serial.println(" repaired.");
+        }
+        else if (((m_RegionCorrupt & (1 << Region)) != 0) || (Print == true))
+        {
+            Serial.print(RegionNames[Region]);
+            Serial.println(((m_RegionCorrupt & (1 << Region)) != 0) ? " corrupt, use verify repair." : " ok.");
+        }
+    }
+
+    if (Seal == true)
+    {
+        EepCommit();
+    }
+    SettingsChecksumUpdate();
+}
+
+/***********************************************************************************************************************
+ */
+void WmcCli::IntegritySeal(uint8_t Change)
+{
+    /* The cli keeps the roster checksum up to date for its own changes only. */
+    if ((Change & (cliChangeRoster | cliChangeLoc)) != 0)
+    {
+        RosterChecksumCalculate();
+    }
+
+    ChangeSeal(Change);
+}
+
+/***********************************************************************************************************************
+ */
+void WmcCli::ChangeSeal(uint8_t Change)
+{
+    if ((Change & (cliChangeRoster | cliChangeLoc)) != 0)
+    {
+        RegionSeal(regionRoster);
+    }
+    if ((Change & (cliChangeAc | cliChangeEmergency)) != 0)
+    {
+        RegionSeal(regionOptions);
+    }
+#if APP_CFG_UC == APP_CFG_UC_ESP8266
+    if ((Change & cliChangeNetwork) != 0)
+    {
+        RegionSeal(regionNetwork);
+    }
+    if ((Change & cliChangeAdc) != 0)
+    {
+        RegionSeal(regionAdc);
+    }
+#endif
+
+    if (Change != cliChangeNone)
+    {
+        EepCommit();
+    }
+    SettingsChecksumUpdate();
+}
+
+/***********************************************************************************************************************
+ */
+uint32_t WmcCli::RegionCrc(uint8_t Region)
+{
+    uint32_t Crc = 0xFFFFFFFF;
+
+    switch (Region)
+    {
+    case regionRoster: Crc = Crc32Update32(Crc, m_RosterChecksum); break;
+    case regionOptions:
+        Crc = Crc32UpdateEep(Crc, EepCfg::AcTypeControlAddress, 1);
+        Crc = Crc32UpdateEep(Crc, EepCfg::EmergencyStopEnabledAddress, 1);
+        break;
+#if APP_CFG_UC == APP_CFG_UC_ESP8266
+    case regionNetwork:
+        Crc = Crc32UpdateEep(Crc, EepCfg::SsidNameAddress, sizeof(m_Scratch.Network.SsidName));
+        Crc = Crc32UpdateEep(Crc, EepCfg::SsidPasswordAddress, sizeof(m_Scratch.Network.SsidPassword));
+        Crc = Crc32UpdateEep(Crc, EepCfg::EepIpAddressZ21, sizeof(m_Scratch.Network.IpAddress));
+        Crc = Crc32UpdateEep(Crc, EepCfg::EepIpAddressWmc, sizeof(m_Scratch.Network.IpAddress));
+        Crc = Crc32UpdateEep(Crc, EepCfg::EepIpGateway, sizeof(m_Scratch.Network.IpAddress));
+        Crc = Crc32UpdateEep(Crc, EepCfg::EepIpSubnet, sizeof(m_Scratch.Network.IpAddress));
+        Crc = Crc32UpdateEep(Crc, EepCfg::StaticIpAddress, 1);
+        break;
+    case regionAdc:
+        Crc = Crc32UpdateEep(Crc, EepCfg::ButtonAdcValuesAddressValid, 1);
+        Crc = Crc32UpdateEep(Crc, EepCfg::ButtonAdcValuesAddress, 14);
+        break;
+#endif
+    default: break;
+    }
+
+    return (~Crc);
+}
+
+/***********************************************************************************************************************
+ */
+void WmcCli::RegionSeal(uint8_t Region)
+{
+    uint16_t Address = IntegrityEepAddress + (Region * 5);
+    uint32_t Crc     = RegionCrc(Region);
+
+    if (m_CliEepValid == true)
+    {
+        EEPROM.write(Address, IntegrityVersion);
+        EEPROM.write(Address + 1, (uint8_t)(Crc >> 24));
+        EEPROM.write(Address + 2, (uint8_t)(Crc >> 16));
+        EEPROM.write(Address + 3, (uint8_t)(Crc >> 8));
+        EEPROM.write(Address + 4, (uint8_t)(Crc));
+    }
+}
+
+/***********************************************************************************************************************
+ * Check the values of a region against their allowed range.
+ */
+bool WmcCli::RegionValid(uint8_t Region)
+{
+    uint16_t Index;
+    uint8_t Button;
+    LocLibData* Data;
+    bool Result = true;
+#if APP_CFG_UC == APP_CFG_UC_ESP8266
+    uint16_t AdcValue;
+#endif
+
+    switch (Region)
+    {
+    case regionRoster:
+        for (Index = 0; Index < m_locLib.GetNumberOfLocs(); Index++)
+        {
+            Data = m_locLib.LocGetAllDataByIndex(Index);
+            if ((Data->Addres == 0) || (Data->Addres > 9999))
+            {
+                Result = false;
+            }
+            for (Button = 0; Button < 5; Button++)
+            {
+                if (Data->FunctionAssignment[Button] > 28)
+                {
+                    Result = false;
+                }
+            }
+        }
+        break;
+    case regionOptions:
+        if ((m_LocStorage.AcOptionGet() > 1) || (m_LocStorage.EmergencyOptionGet() > 1))
+        {
+            Result = false;
+        }
+        break;
+#if APP_CFG_UC == APP_CFG_UC_ESP8266
+    case regionNetwork:
+        if ((EEPROM.read(EepCfg::StaticIpAddress) > 1)
+            || (EEPROM.read(EepCfg::SsidNameAddress + sizeof(m_Scratch.Network.SsidName) - 1) != '\0')
+            || (EEPROM.read(EepCfg::SsidPasswordAddress + sizeof(m_Scratch.Network.SsidPassword) - 1) != '\0'))
+        {
+            Result = false;
+        }
+        break;
+    case regionAdc:
+        if (EEPROM.read(EepCfg::ButtonAdcValuesAddressValid) > 1)
+        {
+            Result = false;
+        }
+        else if (EEPROM.read(EepCfg::ButtonAdcValuesAddressValid) == 1)
+        {
+            for (Index = 0; Index < 7; Index++)
+            {
+                AdcValue = (uint16_t)(EEPROM.read(EepCfg::ButtonAdcValuesAddress + (Index * 2))) << 8;
+                AdcValue |= (uint16_t)(EEPROM.read(EepCfg::ButtonAdcValuesAddress + (Index * 2) + 1));
+                if (AdcValue > 1023)
+                {
+                    Result = false;
+                }
+            }
+        }
+        break;
+#endif
+    default: break;
+    }
+
+    return (Result);
+}
+
+/***********************************************************************************************************************
+ * Repair only restores invalid values, valid data of a region is kept.
+ */
+void WmcCli::RegionRepair(uint8_t Region)
+{
+    uint16_t Index;
+    uint8_t Button;
+    uint8_t Functions[5];
+    bool Invalid;
+    LocLibData* Data;
+
+    switch (Region)
+    {
+    case regionRoster:
+        /* Remove locs with invalid address, reset invalid function assignments. The loc lib is written directly, a
+         * repair at the start is no command so it is not journaled and sends no event. */
+        Index = m_locLib.GetNumberOfLocs();
+        while (Index > 0)
+        {
+            Index--;
+            Data = m_locLib.LocGetAllDataByIndex(Index);
+            if ((Data->Addres == 0) || (Data->Addres > 9999))
+            {
+                m_locLib.RemoveLoc(Data->Addres);
+            }
+            else
+            {
+                Invalid = false;
+                for (Button = 0; Button < 5; Button++)
+                {
+                    Functions[Button] = Data->FunctionAssignment[Button];
+                    if (Functions[Button] > 28)
+                    {
+                        Functions[Button] = Button;
+                        Invalid           = true;
+                    }
+                }
+
+                if (Invalid == true)
+                {
+                    m_locLib.StoreLoc(Data->Addres, Functions, NULL, LocLib::storeChange);
+                }
+            }
+        }
+        LocIndexInvalidate();
+        RosterChecksumCalculate();
+        break;
+    case regionOptions:
+        if (m_LocStorage.AcOptionGet() > 1)
+        {
+            m_LocStorage.AcOptionSet(0);
+        }
+        if (m_LocStorage.EmergencyOptionGet() > 1)
+        {
+            m_LocStorage.EmergencyOptionSet(0);
+        }
+        break;
+#if APP_CFG_UC == APP_CFG_UC_ESP8266
+    case regionNetwork:
+        /* Terminate the strings, the ssid and password themselves are kept. */
+        if (EEPROM.read(EepCfg::StaticIpAddress) > 1)
+        {
+            EEPROM.write(EepCfg::StaticIpAddress, 0);
+        }
+        EEPROM.write(EepCfg::SsidNameAddress + sizeof(m_Scratch.Network.SsidName) - 1, '\0');
+        EEPROM.write(EepCfg::SsidPasswordAddress + sizeof(m_Scratch.Network.SsidPassword) - 1, '\0');
+        break;
+    case regionAdc:
+        if (RegionValid(regionAdc) == false)
+        {
+            /* Buttons are calibrated again at next startup. */
+            m_LocStorage.InvalidateAdc();
+        }
+        break;
+#endif
+    default: break;
+    }
+}
+
+/***********************************************************************************************************************
+ * Bitwise CRC32 (polynomial 0xEDB88320), no table to keep flash usage low.
+ */
+uint32_t WmcCli::Crc32Update(uint32_t Crc, const uint8_t* DataPtr, uint16_t Length)
+{
+    uint8_t Bit;
+
+    while (Length > 0)
+    {
+        Crc ^= *DataPtr;
+        for (Bit = 0; Bit < 8; Bit++)
+        {
+            if ((Crc & 1) != 0)
+            {
+                Crc = (Crc >> 1) ^ 0xEDB88320;
+            }
+            else
+            {
+                Crc >>= 1;
+            }
+        }
+
+        DataPtr++;
+        Length--;
+    }
+
+    return (Crc);
+}
+
+/***********************************************************************************************************************
+ */
+uint32_t WmcCli::Crc32Update32(uint32_t Crc, uint32_t Value)
+{
+    uint8_t Bytes[4];
+
+    Bytes[0] = (uint8_t)(Value >> 24);
+    Bytes[1] = (uint8_t)(Value >> 16);
+    Bytes[2] = (uint8_t)(Value >> 8);
+    Bytes[3] = (uint8_t)(Value);
+
+    return (Crc32Update(Crc, Bytes, sizeof(Bytes)));
+}
+
+/***********************************************************************************************************************
+ */
+uint32_t WmcCli::Crc32UpdateEep(uint32_t Crc, uint16_t Address, uint16_t Length)
+{
+    uint8_t Data;
+
+    while (Length > 0)
+    {
+        Data = EEPROM.read(Address);
+        Crc  = Crc32Update(Crc, &Data, 1);
+        Address++;
+        Length--;
+    }
+
+    return (Crc);
+}
+
+#if (WMC_CLI_MODULE_SYNC == 1) || (WMC_CLI_MODULE_DIAGNOSTICS == 1)
+/***********************************************************************************************************************
+ */
+void WmcCli::PrintHex32(uint32_t Value)
+{
+    char output[9];
+
+    sprintf(output, "%08lX", (unsigned long)(Value));
+    Serial.print(output);
+}
+#endif
+
+#if WMC_CLI_MODULE_IMPORT == 1
+/***********************************************************************************************************************
+ * Minimal streaming XML parser, only the tag name, attribute name and a (truncated) attribute value are kept, so the
+ * size of the imported file is not limited by RAM. Comments, declarations (<?xml ?>, <!DOCTYPE >) and their quoted
+ * or bracketed parts are skipped, the standard entities in attribute values are decoded. Used from the JMRI roster:
+ * <locomotive id="name" dccAddress="3"> with <functionlabel num="x"> elements, the first five functions with a
+ * label are assigned to the buttons.
+ */
+void WmcCli::ImportChar(char Data)
+{
+    static const char* const Entities[]  = { "amp", "lt", "gt", "quot", "apos" };
+    static const char EntityCharacters[] = "&<>\"'";
+    uint8_t Index;
+    bool Space = ((Data == ' ') || (Data == '\t') || (Data == '\r') || (Data == '\n'));
+
+    if (Data == 0x1B)
+    {
+        ImportEnd();
+    }
+    else
+    {
+        switch (m_ImportState)
+        {
+        case importText:
+            if (Data == '<')
+            {
+                m_ImportState     = importTagName;
+                m_ImportTagLength = 0;
+                m_ImportTagClosed = false;
+            }
+            break;
+        case importTagName:
+            if ((m_ImportTagLength == 0) && (Data == '!'))
+            {
+                m_ImportMarkupCount = 0;
+                m_ImportState       = importMarkup;
+            }
+            else if ((m_ImportTagLength == 0) && (Data == '?'))
+            {
+                m_ImportMarkupCount = 0;
+                m_ImportQuote       = '\0';
+                m_ImportState       = importDeclaration;
+            }
+            else if ((Space == true) || (Data == '>') || ((Data == '/') && (m_ImportTagLength > 0)))
+            {
+                m_Scratch.Import.Tag[m_ImportTagLength] = '\0';
+                ImportTag(false);
+
+                m_ImportState           = importAttributeName;
+                m_ImportAttributeLength = 0;
+                if (Data == '>')
+                {
+                    ImportTag(true);
+                    m_ImportState = importText;
+                }
+                else if (Data == '/')
+                {
+                    m_ImportTagClosed = true;
+                }
+            }
+            else if (m_ImportTagLength < (sizeof(m_Scratch.Import.Tag) - 1))
+            {
+                m_Scratch.Import.Tag[m_ImportTagLength] = Data;
+                m_ImportTagLength++;
+            }
+            break;
+        case importMarkup:
+            /* <!-- starts a comment, anything else is a declaration like <!DOCTYPE. */
+            if ((Data == '-') && (m_ImportMarkupCount == 0))
+            {
+                m_ImportMarkupCount = 1;
+            }
+            else if ((Data == '-') && (m_ImportMarkupCount == 1))
+            {
+                m_ImportMarkupCount = 0;
+                m_ImportState       = importComment;
+            }
+            else
+            {
+                m_ImportMarkupCount = 0;
+                m_ImportQuote       = '\0';
+                m_ImportState       = (Data == '>') ? importText : importDeclaration;
+            }
+            break;
+        case importComment:
+            /* The count holds the number of dashes just received, a comment ends with -->. */
+            if (Data == '-')
+            {
+                m_ImportMarkupCount = (m_ImportMarkupCount < 2) ? m_ImportMarkupCount + 1 : 2;
+            }
+            else if ((Data == '>') && (m_ImportMarkupCount == 2))
+            {
+                m_ImportState = importText;
+            }
+            else
+            {
+                m_ImportMarkupCount = 0;
+            }
+            break;
+        case importDeclaration:
+            /* The count holds the depth of [ ], the internal DTD subset of a DOCTYPE may contain >. */
+            if (m_ImportQuote != '\0')
+            {
+                if (Data == m_ImportQuote)
+                {
+                    m_ImportQuote = '\0';
+                }
+            }
+            else if ((Data == '"') || (Data == '\''))
+            {
+                m_ImportQuote = Data;
+            }
+            else if (Data == '[')
+            {
+                m_ImportMarkupCount++;
+            }
+            else if ((Data == ']') && (m_ImportMarkupCount > 0))
+            {
+                m_ImportMarkupCount--;
+            }
+            else if ((Data == '>') && (m_ImportMarkupCount == 0))
+            {
+                m_ImportState = importText;
+            }
+            break;
+        case importAttributeName:
+            if (Data == '=')
+            {
+                m_Scratch.Import.Attribute[m_ImportAttributeLength] = '\0';
+                m_ImportState                                       = importAttributeQuote;
+            }
+            else if (Data == '>')
+            {
+                ImportTag(true);
+                m_ImportState = importText;
+            }
+            else if (Data == '/')
+            {
+                m_ImportTagClosed = true;
+            }
+            else if (Space == true)
+            {
+                m_ImportAttributeLength = 0;
+            }
+            else if (m_ImportAttributeLength < (sizeof(m_Scratch.Import.Attribute) - 1))
+            {
+                m_Scratch.Import.Attribute[m_ImportAttributeLength] = Data;
+                m_ImportAttributeLength++;
+            }
+            break;
+        case importAttributeQuote:
+            if ((Data == '"') || (Data == '\''))
+            {
+                m_ImportQuote       = Data;
+                m_ImportValueLength = 0;
+                m_ImportState       = importAttributeValue;
+            }
+            break;
+        case importAttributeEntity:
+            /* Collect the entity name up to ;, unknown entities are dropped. */
+            if (Data == m_ImportQuote)
+            {
+                m_Scratch.Import.Value[m_ImportValueLength] = '\0';
+                ImportAttribute();
+                m_ImportAttributeLength = 0;
+                m_ImportState           = importAttributeName;
+            }
+            else if (Data == ';')
+            {
+                m_Scratch.Import.Entity[m_ImportMarkupCount] = '\0';
+                for (Index = 0; Index < (sizeof(Entities) / sizeof(Entities[0])); Index++)
+                {
+                    if ((strcmp(m_Scratch.Import.Entity, Entities[Index]) == 0)
+                        && (m_ImportValueLength < (sizeof(m_Scratch.Import.Value) - 1)))
+                    {
+                        m_Scratch.Import.Value[m_ImportValueLength] = EntityCharacters[Index];
+                        m_ImportValueLength++;
+                    }
+                }
+                m_ImportState = importAttributeValue;
+            }
+            else if (m_ImportMarkupCount < (sizeof(m_Scratch.Import.Entity) - 1))
+            {
+                m_Scratch.Import.Entity[m_ImportMarkupCount] = Data;
+                m_ImportMarkupCount++;
+            }
+            break;
+        case importAttributeValue:
+            if (Data == m_ImportQuote)
+            {
+                m_Scratch.Import.Value[m_ImportValueLength] = '\0';
+                ImportAttribute();
+                m_ImportAttributeLength = 0;
+                m_ImportState           = importAttributeName;
+            }
+            else if (Data == '&')
+            {
+                m_ImportMarkupCount = 0;
+                m_ImportState       = importAttributeEntity;
+            }
+            else if (m_ImportValueLength < (sizeof(m_Scratch.Import.Value) - 1))
+            {
+                m_Scratch.Import.Value[m_ImportValueLength] = Data;
+                m_ImportValueLength++;
+            }
+            break;
+        default: m_ImportState = importText; break;
+        }
+    }
+}
+
+/***********************************************************************************************************************
+ */
+void WmcCli::ImportTag(bool Closed)
+{
+    if (Closed == false)
+    {
+        if (strcmp(m_Scratch.Import.Tag, "locomotive") == 0)
+        {
+            m_ImportAddress           = 0;
+            m_ImportNumberOfFunctions = 0;
+            m_Scratch.Import.Name[0]  = '\0';
+        }
+    }
+    else if ((strcmp(m_Scratch.Import.Tag, "/locomotive") == 0)
+        || ((strcmp(m_Scratch.Import.Tag, "locomotive") == 0) && (m_ImportTagClosed == true)))
+    {
+        ImportLocStore();
+    }
+    else if ((strcmp(m_Scratch.Import.Tag, "/roster-config") == 0)
+        || (strcmp(m_Scratch.Import.Tag, "/locomotive-config") == 0))
+    {
+        ImportEnd();
+    }
+}
+
+/***********************************************************************************************************************
+ */
+void WmcCli::ImportAttribute(void)
+{
+    uint16_t Function;
+
+    if (strcmp(m_Scratch.Import.Tag, "locomotive") == 0)
+    {
+        if (strcmp(m_Scratch.Import.Attribute, "id") == 0)
+        {
+            memcpy(m_Scratch.Import.Name, m_Scratch.Import.Value, sizeof(m_Scratch.Import.Name));
+        }
+        else if (strcmp(m_Scratch.Import.Attribute, "dccAddress") == 0)
+        {
+            m_ImportAddress = atoi(m_Scratch.Import.Value);
+        }
+    }
+    else if ((strcmp(m_Scratch.Import.Tag, "functionlabel") == 0) && (strcmp(m_Scratch.Import.Attribute, "num") == 0))
+    {
+        Function = atoi(m_Scratch.Import.Value);
+        if ((Function < 29) && (m_ImportNumberOfFunctions < sizeof(m_ImportFunctions)))
+        {
+            m_ImportFunctions[m_ImportNumberOfFunctions] = (uint8_t)(Function);
+            m_ImportNumberOfFunctions++;
+        }
+    }
+}
+
+/***********************************************************************************************************************
+ * The loc table is sorted once at the end of the import instead of after each added loc.
+ */
+void WmcCli::ImportLocStore(void)
+{
+    uint8_t Index;
+    uint8_t Function = 0;
+    bool Result      = false;
+
+    /* Buttons without a function with label get the lowest unused functions, so without labels 0..4. */
+    for (Index = m_ImportNumberOfFunctions; Index < sizeof(m_ImportFunctions); Index++)
+    {
+        while (memchr(m_ImportFunctions, Function, Index) != NULL)
+        {
+            Function++;
+        }
+
+        m_ImportFunctions[Index] = Function;
+        Function++;
+    }
+
+    if ((m_ImportAddress > 0) && (m_ImportAddress <= 9999))
+    {
+        /* Storing blocks the cli, the host stops sending until the update restarts the flow. */
+        FlowStop();
+        Index = m_locLib.CheckLoc(m_ImportAddress);
+        if (Index == 255)
+        {
+            Result = m_locLib.StoreLoc(m_ImportAddress, m_ImportFunctions, NULL, LocLib::storeAdd);
+            if (Result == true)
+            {
+                UndoRecord(undoOpAdd, m_ImportAddress, NULL);
+            }
+        }
+        else
+        {
+            UndoRecord(undoOpChange, m_ImportAddress, m_locLib.LocGetAllDataByIndex(Index));
+            Result = m_locLib.StoreLoc(m_ImportAddress, m_ImportFunctions, NULL, LocLib::storeChange);
+        }
+
+        if ((Result == true) && (strlen(m_Scratch.Import.Name) > 0))
+        {
+            m_locLib.StoreLoc(m_ImportAddress, NULL, m_Scratch.Import.Name, LocLib::storeChange);
+            NamePoolStore(m_ImportAddress, m_Scratch.Import.Name);
+        }
+    }
+
+    if (Result == true)
+    {
+        m_ImportNumberOfLocs++;
+    }
+    else
+    {
+        m_ImportNumberOfFailures++;
+    }
+
+    m_ImportAddress = 0;
+}
+
+/***********************************************************************************************************************
+ */
+void WmcCli::ImportEnd(void)
+{
+    m_ImportActive = false;
+
+    if (m_ImportNumberOfLocs > 0)
+    {
+        FlowStop();
+        m_locLib.LocBubbleSort();
+        LocIndexInvalidate();
+        RosterChecksumCalculate();
+        ChangeSet(cliChangeRoster);
+    }
+
+    Serial.println();
+    Serial.print(m_ImportNumberOfLocs);
+    Serial.print(" locs imported, ");
+    Serial.print(m_ImportNumberOfFailures);
+    Serial.print(" failed in ");
+    Serial.print(millis() - m_ImportStartTime);
+    Serial.println(" ms.");
+}
+#endif
+
+/***********************************************************************************************************************
+ * After switching the baud rate the host has to send "baud ok" at the new baud rate, otherwise the default baud rate
+ * is restored, so a not working baud rate never makes the cli unreachable.
+ */
+void WmcCli::BaudCommand(void)
+{
+    uint8_t Index;
+    uint32_t BaudRate;
+    const uint32_t BaudRates[] = { 115200, 230400, 460800, 921600, 1000000, 2000000 };
+
+    if (strncmp(&m_bufferRx[strlen(Baud)], " ok", 3) == 0)
+    {
+        if (m_BaudPending == true)
+        {
+            m_BaudPending = false;
+            Serial.print("Baud rate ");
+            Serial.print(m_BaudRate);
+            Serial.println(" active.");
+            FlowRelease();
+        }
+        else
+        {
+            Serial.println("No baud rate switch active.");
+        }
+    }
+    else if (m_bufferRx[strlen(Baud)] == ' ')
+    {
+        BaudRate = strtoul(&m_bufferRx[strlen(Baud)], NULL, 10);
+
+        for (Index = 0; Index < sizeof(BaudRates) / sizeof(BaudRates[0]); Index++)
+        {
+            if (BaudRates[Index] == BaudRate)
+            {
+                break;
+            }
+        }
+
+        if (Index < sizeof(BaudRates) / sizeof(BaudRates[0]))
+        {
+            /* The host stopped by this command must be released at the old baud rate. */
+            Serial.print("Switching to ");
+            Serial.print(BaudRate);
+            Serial.println(" baud, send baud ok within 5 seconds.");
+            FlowRelease();
+            Serial.flush();
+
+            m_BaudRate       = BaudRate;
+            m_BaudSwitchTime = millis();
+            m_BaudPending    = (BaudRate != BaudRateDefault);
+            Serial.begin(m_BaudRate);
+            FlowRelease();
+        }
+        else
+        {
+            Serial.println("Baud rate invalid, use 115200, 230400, 460800, 921600, 1000000 or 2000000.");
+        }
+    }
+    else
+    {
+        Serial.print("Baud rate ");
+        Serial.println(m_BaudRate);
+    }
+}
+
+/***********************************************************************************************************************
+ */
+void WmcCli::BaudUpdate(void)
+{
+    if ((m_BaudPending == true) && ((millis() - m_BaudSwitchTime) > BaudConfirmTimeout))
+    {
+        /* Release the host on both baud rates, it may still use the new one. */
+        FlowRelease();
+        Serial.flush();
+        m_BaudPending = false;
+        m_BaudRate    = BaudRateDefault;
+        Serial.begin(m_BaudRate);
+        Serial.println("Baud rate not confirmed, back to 115200.");
+        FlowRelease();
+    }
+}
+
+/***********************************************************************************************************************
+ * With flow control the cli stops the host while a command is executed, so a restore script can be sent at full
+ * speed. Without flow control the host has to wait for the echo of each command.
+ */
+void WmcCli::FlowCommand(void)
+{
+    const char* Modes[] = { "none", "xon", "rts" };
+    uint8_t Index;
+
+    if (m_bufferRx[strlen(Flow)] == ' ')
+    {
+        for (Index = 0; Index < sizeof(Modes) / sizeof(Modes[0]); Index++)
+        {
+            if (strcmp(&m_bufferRx[strlen(Flow) + 1], Modes[Index]) == 0)
+            {
+                break;
+            }
+        }
+
+#ifndef WMC_CLI_RTS_PIN
+        if (Index == flowRts)
+        {
+            Serial.println("No rts pin available.");
+        }
+        else
+#endif
+            if (Index < sizeof(Modes) / sizeof(Modes[0]))
+        {
+            /* Flow is stopped while this command is executed, restart it with the old flow control. */
+            FlowStart();
+            m_FlowControl = Index;
+            FlowStop();
         }
         else
         {
-            Serial.print("Loc ");
-            Serial.print(m_Address);
-            Serial.println(" is not present.");
+            Serial.println("Flow control invalid, use none, xon or rts.");
         }
     }
-    else
-    {
-        Serial.println("Command invalid.");
-    }
 
-    return (Result);
+    Serial.print("Flow control ");
+    Serial.println(Modes[m_FlowControl]);
 }
 
 /***********************************************************************************************************************
  */
-void WmcCli::ListAllLocs(void)
+void WmcCli::FlowStop(void)
 {
-    uint8_t Index = 0;
-    LocLibData* Data;
-    char output[30];
-
-    /* Print header. */
-    Serial.println("          Functions                         Functions               ");
-    Serial.println("Address B0 B1 B2 B3 B4  Name      Address B0 B1 B2 B3 B4  Name      ");
-
-    /* Print two locs with info on one line. */
-    while (Index < m_locLib.GetNumberOfLocs())
+    if (m_FlowStopped == false)
     {
-        Data = m_locLib.LocGetAllDataByIndex(Index);
-        sprintf(output, "%4hu    %2hu %2hu %2hu %2hu %2hu %-8s", Data->Addres, Data->FunctionAssignment[0],
-            Data->FunctionAssignment[1], Data->FunctionAssignment[2], Data->FunctionAssignment[3],
-            Data->FunctionAssignment[4], Data->Name);
-        Serial.print(output);
-
-        Index++;
-        if ((Index % 2) == 0)
+        m_FlowStopped = true;
+        switch (m_FlowControl)
         {
-            Serial.println();
+        case flowXonXoff: Serial.write(FlowXoff); break;
+#ifdef WMC_CLI_RTS_PIN
+        case flowRts: digitalWrite(WMC_CLI_RTS_PIN, HIGH); break;
+#endif
+        default: break;
         }
     }
-
-    Serial.println();
 }
 
 /***********************************************************************************************************************
  */
-bool WmcCli::EmergencyChange(void)
+void WmcCli::FlowStart(void)
 {
-    char* Space;
-    uint8_t EmergencyOption;
-    bool Result = false;
-
-    Space = strchr(m_bufferRx, 32);
-
-    if (Space != NULL)
+    if (m_FlowStopped == true)
     {
-        Space++;
-
-        EmergencyOption = atoi(Space);
-
-        switch (EmergencyOption)
+        m_FlowStopped = false;
+        switch (m_FlowControl)
         {
-        case 0:
-            m_LocStorage.EmergencyOptionSet(0);
-            Serial.println("Stop option set to power off.");
-            Result = true;
-            break;
-        case 1:
-            m_LocStorage.EmergencyOptionSet(1);
-            Serial.println("Stop option set to emergency stop");
-            Result = true;
-            break;
-        default:
-            Serial.println("Emergency entry invalid, set to power off.");
-            m_LocStorage.EmergencyOptionSet(0);
-            break;
+        case flowXonXoff: Serial.write(FlowXon); break;
+#ifdef WMC_CLI_RTS_PIN
+        case flowRts: digitalWrite(WMC_CLI_RTS_PIN, LOW); break;
+#endif
+        default: break;
         }
     }
-    else
-    {
-        Serial.println("Emergency option entry invalid, must be emergency 0 or emergency 1");
-    }
-
-    return (Result);
 }
+
 /***********************************************************************************************************************
  */
-bool WmcCli::AcControlType(void)
+void WmcCli::FlowRelease(void)
 {
-    uint8_t AcOption;
-    char* Space;
-    bool Result = false;
-
-    Space = strchr(m_bufferRx, 32);
-
-    if (Space != NULL)
-    {
-        Space++;
-
-        AcOption = atoi(Space);
-
-        switch (AcOption)
-        {
-        case 0:
-            m_LocStorage.AcOptionSet(AcOption);
-            Serial.println("AC option disabled.");
-            Result = true;
-            break;
-        case 1:
-            m_LocStorage.AcOptionSet(AcOption);
-            Serial.println("AC option enabled.");
-            Result = true;
-            break;
-        default:
-            Serial.println("AC option entry invalid, option set to disabled.");
-            m_LocStorage.AcOptionSet(0);
-            break;
-        }
-    }
-    else
-    {
-        Serial.println("AC option entry invalid, must be ac 0 or ac 1");
-    }
-
-    return (Result);
+    m_FlowStopped = true;
+    FlowStart();
 }
 
-#if APP_CFG_UC == APP_CFG_UC_ESP8266
 /***********************************************************************************************************************
  */
-bool WmcCli::StaticIpChange(void)
+void WmcCli::SettingsGet(void)
 {
-    uint8_t StaticIp;
-    char* Space;
-    bool Result = false;
+    const char* KeyPtr;
+    uint8_t Length;
+    uint8_t Index;
 
-    Space = strchr(m_bufferRx, 32);
+    KeyPtr = strchr(m_bufferRx, ' ');
 
-    if (Space != NULL)
+    if (KeyPtr == NULL)
     {
-        Space++;
-
-        StaticIp = (uint8_t)(atoi(Space));
-
-        switch (StaticIp)
+        for (Index = 0; Index < SettingsTableSize; Index++)
         {
-        case 0:
-            Result = true;
-            EEPROM.write(EepCfg::StaticIpAddress, StaticIp);
-            EEPROM.commit();
-            Serial.println("Dynamic IP Address WMC disabled.");
-            break;
-        case 1:
-            Result = true;
-            EEPROM.write(EepCfg::StaticIpAddress, StaticIp);
-            EEPROM.commit();
-            Serial.println("Dynamic IP Address WMC enabled.");
-            break;
-        default: Serial.println("Dynamic IP entry invalid"); break;
+            SettingPrint(Index);
         }
     }
     else
     {
-        Serial.println("Dynamic IP entry invalid");
-    }
+        /* Print each requested setting. */
+        while (KeyPtr != NULL)
+        {
+            KeyPtr++;
+            Length = strcspn(KeyPtr, " ");
 
-    return (Result);
+            if (Length > 0)
+            {
+                Index = SettingFind(KeyPtr, Length);
+                if (Index != 255)
+                {
+                    SettingPrint(Index);
+                }
+                else
+                {
+                    Serial.write((const uint8_t*)(KeyPtr), Length);
+                    Serial.println(" unknown");
+                }
+            }
+
+            KeyPtr = strchr(KeyPtr, ' ');
+        }
+    }
 }
 
 /***********************************************************************************************************************
  */
-bool WmcCli::IpAddressWriteWmc(void)
+void WmcCli::SettingsSet(void)
 {
-    bool Result = true;
-    if (IpGetData(Ip, m_IpAddresWmc) == true)
-    {
-        EEPROM.put(EepCfg::EepIpAddressWmc, m_IpAddresWmc);
-        EEPROM.commit();
+    char* ValuePtr;
+
+    ValuePtr = strchr(&m_bufferRx[strlen(Set)], ' ');
 
-        Serial.print("IP Address WMC stored : ");
-        Serial.print(m_IpAddresWmc[0]);
-        Serial.print(".");
-        Serial.print(m_IpAddresWmc[1]);
-        Serial.print(".");
-        Serial.print(m_IpAddresWmc[2]);
-        Serial.print(".");
-        Serial.println(m_IpAddresWmc[3]);
+    if (ValuePtr != NULL)
+    {
+        *ValuePtr = '\0';
+        ValuePtr++;
+        SettingApply(&m_bufferRx[strlen(Set)], ValuePtr);
     }
     else
     {
-        Result = false;
-        Serial.println("IP Address WMC entry invalid.");
+        Serial.println("Set command invalid, use set key value.");
     }
-
-    return (Result);
 }
 
 /***********************************************************************************************************************
  */
-bool WmcCli::IpAddressWriteGateway(void)
+void WmcCli::SettingApply(const char* KeyPtr, const char* ValuePtr)
 {
-    bool Result = true;
-    if (IpGetData(Gateway, m_IpGateway) == true)
-    {
-        EEPROM.put(EepCfg::EepIpGateway, m_IpGateway);
-        EEPROM.commit();
+    uint8_t Index = SettingFind(KeyPtr, strlen(KeyPtr));
 
-        Serial.print("IP Gateway stored : ");
-        Serial.print(m_IpGateway[0]);
-        Serial.print(".");
-        Serial.print(m_IpGateway[1]);
-        Serial.print(".");
-        Serial.print(m_IpGateway[2]);
-        Serial.print(".");
-        Serial.println(m_IpGateway[3]);
+    if (Index == 255)
+    {
+        Serial.println("Setting unknown.");
     }
-    else
+    else if (SettingWrite(Index, ValuePtr) == true)
     {
-        Result = false;
-        Serial.println("IP Gateway entry invalid!");
+#if APP_CFG_UC == APP_CFG_UC_ESP8266
+        if (SettingsTable[Index].Change != networkChangeNone)
+        {
+            /* The network is applied later, the written data is sealed now. */
+            NetworkChangeSet(SettingsTable[Index].Change);
+            m_ChangeSeal |= SettingsTable[Index].Event;
+        }
+        else
+#endif
+        {
+            ChangeSet(SettingsTable[Index].Event);
+        }
     }
-
-    return (Result);
 }
 
 /***********************************************************************************************************************
  */
-bool WmcCli::IpAddressWriteSubnet(void)
+uint8_t WmcCli::SettingFind(const char* KeyPtr, uint8_t Length)
 {
-    bool Result = true;
-    if (IpGetData(Subnet, m_IpSubnet) == true)
-    {
-        EEPROM.put(EepCfg::EepIpSubnet, m_IpSubnet);
-        EEPROM.commit();
+    uint8_t Index;
+    uint8_t Result = 255;
 
-        Serial.print("IP Subnet stored : ");
-        Serial.print(m_IpSubnet[0]);
-        Serial.print(".");
-        Serial.print(m_IpSubnet[1]);
-        Serial.print(".");
-        Serial.print(m_IpSubnet[2]);
-        Serial.print(".");
-        Serial.println(m_IpSubnet[3]);
-    }
-    else
+    for (Index = 0; (Index < SettingsTableSize) && (Result == 255); Index++)
     {
-        Result = false;
-        Serial.println("IP Subnet entry invalid");
+        if ((strlen(SettingsTable[Index].Key) == Length) && (strncmp(SettingsTable[Index].Key, KeyPtr, Length) == 0))
+        {
+            Result = Index;
+        }
     }
 
     return (Result);
@@ -798,109 +5307,139 @@ bool WmcCli::IpAddressWriteSubnet(void)
 
 /***********************************************************************************************************************
  */
-void WmcCli::PrintButtonAdcData(void)
+bool WmcCli::SettingWrite(uint8_t Index, const char* ValuePtr)
 {
-    uint8_t AdcValid;
-    uint8_t Index     = 0;
-    uint16_t AdcValue = 0;
+    uint8_t Data[4];
+    uint8_t Offset;
+    uint8_t Length;
+    bool Result                      = false;
+    const settingDescriptor* Setting = &SettingsTable[Index];
 
-    AdcValid = EEPROM.read(EepCfg::ButtonAdcValuesAddressValid);
+    /* The legacy commands like static and ip pass the value with the separating space, only strings keep it. */
+    if (Setting->Type != settingTypeString)
+    {
+        while (*ValuePtr == ' ')
+        {
+            ValuePtr++;
+        }
+    }
 
-    if (AdcValid == 1)
+    switch (Setting->Type)
     {
-        for (Index = 0; Index < 7; Index++)
+    case settingTypeOption:
+        /* Check the text, a cast of atoi() would turn 256 into 0. */
+        if (((ValuePtr[0] == '0') || (ValuePtr[0] == '1')) && (ValuePtr[1] == '\0'))
         {
-            AdcValue = (uint16_t)(EEPROM.read(EepCfg::ButtonAdcValuesAddress + (Index * 2))) << 8;
-            AdcValue |= (uint16_t)(EEPROM.read(EepCfg::ButtonAdcValuesAddress + (Index * 2) + 1));
-            if (Index <= 5)
+            Data[0] = (uint8_t)(ValuePtr[0] - '0');
+            if (Setting->Event == cliChangeAc)
             {
-                Serial.print("Button    : ");
-                Serial.print(Index);
-                Serial.print(" : ");
+                m_LocStorage.AcOptionSet(Data[0]);
+            }
+            else if (Setting->Event == cliChangeEmergency)
+            {
+                m_LocStorage.EmergencyOptionSet(Data[0]);
             }
             else
             {
-                Serial.print("Reference     : ");
+                EEPROM.write(Setting->EepAddress, Data[0]);
             }
-            Serial.println(AdcValue);
+            Result = true;
+        }
+        break;
+    case settingTypeString:
+        Length = strlen(ValuePtr);
+        if (Length < Setting->Size)
+        {
+            /* Store string including unused part, so no old data remains. */
+            for (Offset = 0; Offset < Setting->Size; Offset++)
+            {
+                EEPROM.write(Setting->EepAddress + Offset, (Offset < Length) ? ValuePtr[Offset] : '\0');
+            }
+            Result = true;
         }
+        break;
+#if APP_CFG_UC == APP_CFG_UC_ESP8266
+    case settingTypeIp:
+        if (IpGetData(ValuePtr, Data) == true)
+        {
+            for (Offset = 0; Offset < sizeof(Data); Offset++)
+            {
+                EEPROM.write(Setting->EepAddress + Offset, Data[Offset]);
+            }
+            Result = true;
+        }
+        break;
+#endif
+    default: break;
+    }
+
+    if (Result == true)
+    {
+        EepCommit();
+        SettingsChecksumUpdate();
+        Serial.print("Stored : ");
+        SettingPrint(Index);
     }
     else
     {
-        Serial.println("Button ADC data not valid");
+        Serial.print(Setting->Key);
+        Serial.println(" entry invalid!");
     }
-}
 
-#endif
+    return (Result);
+}
 
 /***********************************************************************************************************************
  */
-void WmcCli::DumpData(void)
+void WmcCli::SettingPrint(uint8_t Index)
 {
-    uint8_t Index          = 0;
-    uint8_t FunctionIndex  = 0;
-    uint16_t AcOption      = 0;
-    uint16_t EmergencyStop = 0;
-    LocLibData* Data       = NULL;
+    char Data;
+    uint8_t Offset;
+    const settingDescriptor* Setting = &SettingsTable[Index];
 
-    // Loc address and functions
-    while (Index < m_locLib.GetNumberOfLocs())
-    {
-        Data = m_locLib.LocGetAllDataByIndex(Index);
-        Serial.print(LocAdd);
-        Serial.println(Data->Addres);
+    Serial.print(Setting->Key);
+    Serial.print(" ");
 
-        for (FunctionIndex = 0; FunctionIndex < 5; FunctionIndex++)
+    switch (Setting->Type)
+    {
+    case settingTypeString:
+        for (Offset = 0; Offset < Setting->Size; Offset++)
         {
-            Serial.print(LocChange);
-            Serial.print(Data->Addres);
-            Serial.print(" ");
-            Serial.print(FunctionIndex);
-            Serial.print(" ");
-            Serial.println(Data->FunctionAssignment[FunctionIndex]);
+            Data = (char)(EEPROM.read(Setting->EepAddress + Offset));
+            if (Data == '\0')
+            {
+                break;
+            }
+            Serial.print(Data);
         }
-
-        Index++;
-    }
-
-    // Locnames
-    Index = 0;
-    while (Index < m_locLib.GetNumberOfLocs())
-    {
-        Data = m_locLib.LocGetAllDataByIndex(Index);
-        if (strlen(Data->Name) > 0)
+        Serial.println();
+        break;
+    case settingTypeIp:
+        for (Offset = 0; Offset < 4; Offset++)
         {
-            Serial.print(LocName);
-            Serial.print(Data->Addres);
-            Serial.print(" ");
-            Serial.println(Data->Name);
+            Serial.print(EEPROM.read(Setting->EepAddress + Offset));
+            if (Offset < 3)
+            {
+                Serial.print(".");
+            }
         }
-        Index++;
-    }
-
-    /* Dump the AC option. */
-    Serial.print(Ac);
-    Serial.print(" ");
-    AcOption = EEPROM.read(EepCfg::AcTypeControlAddress);
-    if (AcOption > 1)
-    {
-        AcOption = 0;
-    }
-    Serial.println(AcOption);
-
-    /* Dump the emergency option. */
-    Serial.print(Emergency);
-    Serial.print(" ");
-    EmergencyStop = EEPROM.read(EepCfg::EmergencyStopEnabledAddress);
-    if (EmergencyStop > 1)
-    {
-        EmergencyStop = 0;
+        Serial.println();
+        break;
+    default:
+        if (Setting->Event == cliChangeAc)
+        {
+            Serial.println(m_LocStorage.AcOptionGet());
+        }
+        else if (Setting->Event == cliChangeEmergency)
+        {
+            Serial.println(m_LocStorage.EmergencyOptionGet());
+        }
+        else
+        {
+            Serial.println(EEPROM.read(Setting->EepAddress));
+        }
+        break;
     }
-    Serial.println(EmergencyStop);
-
-#if APP_CFG_UC == APP_CFG_UC_ESP8266
-    ShowNetworkSettings();
-#endif
 }
 
 /***********************************************************************************************************************
@@ -909,14 +5448,24 @@ void WmcCli::ShowSettings(void)
 {
 #if APP_CFG_UC == APP_CFG_UC_ESP8266
     uint8_t Static;
-    memset(m_IpAddressZ21, 0, sizeof(m_IpAddressZ21));
-    memset(m_SsidName, '\0', sizeof(m_SsidName));
-    memset(m_SsidPassword, '\0', sizeof(m_SsidPassword));
+    memset(&m_Scratch.Network, 0, sizeof(m_Scratch.Network));
 #endif
 
     Serial.print("Number of locs  : ");
     Serial.println(m_locLib.GetNumberOfLocs());
 
+    Serial.print("Roster gen.     : ");
+    Serial.println(m_RosterGeneration);
+
+    if (m_CliEepValid == true)
+    {
+        Serial.print("Name pool       : ");
+        Serial.print(NamePoolUsedGet());
+        Serial.print(" of ");
+        Serial.print(WMC_CLI_NAME_POOL_SIZE - 2);
+        Serial.println(" bytes");
+    }
+
     Serial.print("Ac control      : ");
     if (m_LocStorage.AcOptionGet() == 1)
     {
@@ -941,30 +5490,32 @@ void WmcCli::ShowSettings(void)
     Serial.println(m_LocStorage.XpNetAddressGet());
 #else
     /* Get and print the network settings. */
-    EEPROM.get(EepCfg::SsidNameAddress, m_SsidName);
+    EEPROM.get(EepCfg::SsidNameAddress, m_Scratch.Network.SsidName);
+    m_Scratch.Network.SsidName[sizeof(m_Scratch.Network.SsidName) - 1] = '\0';
     Serial.print("Ssid            : ");
-    Serial.println(m_SsidName);
+    Serial.println(m_Scratch.Network.SsidName);
 
-    EEPROM.get(EepCfg::SsidPasswordAddress, m_SsidPassword);
+    EEPROM.get(EepCfg::SsidPasswordAddress, m_Scratch.Network.SsidPassword);
+    m_Scratch.Network.SsidPassword[sizeof(m_Scratch.Network.SsidPassword) - 1] = '\0';
     Serial.print("Password        : ");
-    Serial.println(m_SsidPassword);
+    Serial.println(m_Scratch.Network.SsidPassword);
 
-    EEPROM.get(EepCfg::EepIpAddressZ21, m_IpAddressZ21);
-    IpDataPrint("Ip address Z21  : ", m_IpAddressZ21);
+    EEPROM.get(EepCfg::EepIpAddressZ21, m_Scratch.Network.IpAddress);
+    IpDataPrint("Ip address Z21  : ", m_Scratch.Network.IpAddress);
 
     Static = EEPROM.read(EepCfg::StaticIpAddress);
     if (Static == 1)
     {
         Serial.println("Static IP       : Enabled.");
 
-        EEPROM.get(EepCfg::EepIpAddressWmc, m_IpAddresWmc);
-        IpDataPrint("Ip address WMC  : ", m_IpAddresWmc);
+        EEPROM.get(EepCfg::EepIpAddressWmc, m_Scratch.Network.IpAddress);
+        IpDataPrint("Ip address WMC  : ", m_Scratch.Network.IpAddress);
 
-        EEPROM.get(EepCfg::EepIpGateway, m_IpGateway);
-        IpDataPrint("Ip gateway      : ", m_IpGateway);
+        EEPROM.get(EepCfg::EepIpGateway, m_Scratch.Network.IpAddress);
+        IpDataPrint("Ip gateway      : ", m_Scratch.Network.IpAddress);
 
-        EEPROM.get(EepCfg::EepIpSubnet, m_IpSubnet);
-        IpDataPrint("Ip subnet       : ", m_IpSubnet);
+        EEPROM.get(EepCfg::EepIpSubnet, m_Scratch.Network.IpAddress);
+        IpDataPrint("Ip subnet       : ", m_Scratch.Network.IpAddress);
     }
     else
     {
@@ -976,17 +5527,17 @@ void WmcCli::ShowSettings(void)
 #if APP_CFG_UC == APP_CFG_UC_ESP8266
 /***********************************************************************************************************************
  */
-bool WmcCli::IpGetData(const char* SourcePtr, uint8_t* TargetPtr)
+bool WmcCli::IpGetData(const char* StrPtr, uint8_t* TargetPtr)
 {
-    char* Dot;
+    const char* Dot;
     bool Result   = true;
     uint8_t Index = 0;
 
     /* s(s)canf is not present, so get digits by locating the dot and getting value from the dot location with
      * atoi function. */
 
-    TargetPtr[0] = atoi(&m_bufferRx[strlen(SourcePtr)]);
-    Dot          = &m_bufferRx[strlen(SourcePtr)];
+    TargetPtr[0] = atoi(StrPtr);
+    Dot          = StrPtr;
 
     while ((Index < 3) && (Dot != NULL))
     {
@@ -1026,23 +5577,31 @@ void WmcCli::IpSettingsDefault(void)
 {
     uint8_t IpAddressZ21[4] = { 192, 168, 2, 112 };
     uint8_t IpAddressWmc[4] = { 192, 168, 2, 5 };
-    uint8_t m_IpGateway[4]  = { 192, 168, 2, 1 };
-    uint8_t m_IpSubnet[4]   = { 255, 255, 255, 0 };
+    uint8_t IpGateway[4]    = { 192, 168, 2, 1 };
+    uint8_t IpSubnet[4]     = { 255, 255, 255, 0 };
     uint8_t ipStatic        = 0;
+    const char* SsidName    = "YourSsid";
+    const char* SsidPass    = "SsidPassword";
+    uint8_t Index;
 
-    memcpy(m_SsidName, "YourSsid", strlen("YourSsid"));
-    EEPROM.put(EepCfg::SsidNameAddress, m_SsidName);
+    /* Written directly, this function may be called while an import or macro recording uses the scratch buffer. */
+    for (Index = 0; Index < sizeof(m_Scratch.Network.SsidName); Index++)
+    {
+        EEPROM.write(EepCfg::SsidNameAddress + Index, (Index < strlen(SsidName)) ? SsidName[Index] : '\0');
+    }
 
-    memcpy(m_SsidName, "SsidPassword", strlen("SsidPassword"));
-    EEPROM.put(EepCfg::SsidPasswordAddress, m_SsidPassword);
+    for (Index = 0; Index < sizeof(m_Scratch.Network.SsidPassword); Index++)
+    {
+        EEPROM.write(EepCfg::SsidPasswordAddress + Index, (Index < strlen(SsidPass)) ? SsidPass[Index] : '\0');
+    }
 
-    EEPROM.put(EepCfg::EepIpSubnet, m_IpSubnet);
-    EEPROM.put(EepCfg::EepIpGateway, m_IpGateway);
+    EEPROM.put(EepCfg::EepIpSubnet, IpSubnet);
+    EEPROM.put(EepCfg::EepIpGateway, IpGateway);
     EEPROM.put(EepCfg::EepIpAddressZ21, IpAddressZ21);
     EEPROM.put(EepCfg::EepIpAddressWmc, IpAddressWmc);
 
     EEPROM.write(EepCfg::StaticIpAddress, ipStatic);
 
-    EEPROM.commit();
+    EepCommit();
 }
 #endif
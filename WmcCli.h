@@ -21,16 +21,186 @@
 #endif
 #include <Arduino.h>
 
+/***********************************************************************************************************************
+ * D E F I N E S
+ **********************************************************************************************************************/
+#ifndef WMC_CLI_EEP_ADDRESS
+/* Start of the EEPROM area used by the cli itself (macros), must be located behind the EepCfg regions. */
+#define WMC_CLI_EEP_ADDRESS 2048
+#endif
+
+#ifndef WMC_CLI_EEP_SIZE
+/* Size of the EEPROM used by the application, the cli EEPROM area must end within it. */
+#define WMC_CLI_EEP_SIZE 4096
+#endif
+
+#ifndef WMC_CLI_LOC_INDEX_SIZE
+/* Number of entries (power of 2) of the loc address index, must be larger than the max number of locs. Each entry
+   takes 2 bytes of RAM, 0 leaves the index out and locs are searched by the loc lib. */
+#define WMC_CLI_LOC_INDEX_SIZE 256
+#endif
+
+#if (WMC_CLI_LOC_INDEX_SIZE != 0)                                                                                      \
+    && ((WMC_CLI_LOC_INDEX_SIZE < 2) || ((WMC_CLI_LOC_INDEX_SIZE & (WMC_CLI_LOC_INDEX_SIZE - 1)) != 0))
+#error "WMC_CLI_LOC_INDEX_SIZE must be 0 or a power of 2."
+#endif
+
+/* Optional command modules, a module set to 0 is left out of the build (handlers, strings, help and data). */
+#ifndef WMC_CLI_MODULE_MACRO
+/* macro record / end / abort / run / list / del. */
+#define WMC_CLI_MODULE_MACRO 1
+#endif
+
+#ifndef WMC_CLI_MODULE_IMPORT
+/* JMRI roster import. */
+#define WMC_CLI_MODULE_IMPORT 1
+#endif
+
+#ifndef WMC_CLI_MODULE_SYNC
+/* sync with the host (loc hashes and loc records). */
+#define WMC_CLI_MODULE_SYNC 1
+#endif
+
+#ifndef WMC_CLI_MODULE_PROFILE
+/* Roster profiles stored in the cli EEPROM area. */
+#define WMC_CLI_MODULE_PROFILE 1
+#endif
+
+#ifndef WMC_CLI_MODULE_UNDO
+/* Undo journal of loc changes. */
+#define WMC_CLI_MODULE_UNDO 1
+#endif
+
+#ifndef WMC_CLI_MODULE_DIAGNOSTICS
+/* checksum, bench, eep and buttons. */
+#define WMC_CLI_MODULE_DIAGNOSTICS 1
+#endif
+
+#ifndef WMC_CLI_MODULE_TRACE
+/* Trace ring and trace dump / clear, the ring takes WMC_CLI_TRACE_SIZE * sizeof(traceEntry) bytes of RAM. */
+#define WMC_CLI_MODULE_TRACE 1
+#endif
+
+#ifndef WMC_CLI_PROFILE_SLOTS
+/* Number of roster profiles. */
+#define WMC_CLI_PROFILE_SLOTS 2
+#endif
+
+#ifndef WMC_CLI_PROFILE_LOCS
+/* Max number of locs of a roster profile and of the roster of a clear which can be undone. */
+#define WMC_CLI_PROFILE_LOCS 24
+#endif
+
+#ifndef WMC_CLI_UNDO_RECORDS
+/* Number of records (max 255) of the undo journal. */
+#define WMC_CLI_UNDO_RECORDS 16
+#endif
+
+#ifndef WMC_CLI_NAME_LENGTH
+/* Max length (max 31) of a loc name. Names longer than the loc lib name are stored in the name pool. */
+#define WMC_CLI_NAME_LENGTH 24
+#endif
+
+#if (WMC_CLI_NAME_LENGTH < 10) || (WMC_CLI_NAME_LENGTH > 31)
+#error "WMC_CLI_NAME_LENGTH must be 10..31."
+#endif
+
+#ifndef WMC_CLI_NAME_POOL_SIZE
+/* Size in bytes of the name pool in the cli EEPROM area. */
+#define WMC_CLI_NAME_POOL_SIZE 128
+#endif
+
+#ifndef WMC_CLI_TRACE_SIZE
+/* Number of entries (power of 2, max 128) of the trace ring. */
+#define WMC_CLI_TRACE_SIZE 32
+#endif
+
+#if (WMC_CLI_TRACE_SIZE < 1) || (WMC_CLI_TRACE_SIZE > 128) || ((WMC_CLI_TRACE_SIZE & (WMC_CLI_TRACE_SIZE - 1)) != 0)
+#error "WMC_CLI_TRACE_SIZE must be a power of 2, max 128."
+#endif
+
+#ifndef WMC_CLI_BENCH_OPS
+/* Number of repetitions (max 255) of a fast operation within one bench sample. */
+#define WMC_CLI_BENCH_OPS 16
+#endif
+
+#if (APP_CFG_UC == APP_CFG_UC_ESP8266) && !defined(WMC_CLI_RX_BUFFER_SIZE)
+/* Size of the serial receive buffer, holds the data received while a command is executed. */
+#define WMC_CLI_RX_BUFFER_SIZE 512
+#endif
+
+/* The receive buffer of the STM32 core is fixed at 64 bytes (USART_RX_BUF_SIZE of libmaple) and can't be set here.
+ * After xoff or rts the host must stop within 64 bytes, else data is lost during a command or an import store. A
+ * host with a larger hardware fifo (e.g. 128 bytes of an FTDI) needs a larger USART_RX_BUF_SIZE in the build flags
+ * of the core. */
+
+/* Define WMC_CLI_RTS_PIN with the pin connected to RTS of the host to enable flow rts, the pin is low when the cli
+ * is ready to receive data. */
+
 /***********************************************************************************************************************
  * T Y P E D E F S  /  E N U M
  **********************************************************************************************************************/
 
+/* Type of a setting, defines validation and format of the value. */
+enum settingType
+{
+    settingTypeOption = 0, /* 0 or 1 */
+    settingTypeString,
+    settingTypeIp
+};
+
+/* Description of a setting for the get and set commands. */
+struct settingDescriptor
+{
+    const char* Key;
+    uint16_t EepAddress;
+    uint8_t Type;
+    uint8_t Size;
+    uint8_t Event;  /* Change reported with the cli event. */
+    uint8_t Change; /* Network impact of a change. */
+};
+
+/* Entry of the trace ring. */
+struct traceEntry
+{
+    uint32_t Time; /* micros() */
+    uint8_t Id;
+    uint16_t Data;
+};
+
 /***********************************************************************************************************************
  * C L A S S E S
  **********************************************************************************************************************/
 class WmcCli
 {
 public:
+    /* Data changed by the cli, reported together with the cli event. */
+    enum cliChange
+    {
+        cliChangeNone      = 0x00,
+        cliChangeRoster    = 0x01, /* Locs added or deleted, or more than one loc changed. */
+        cliChangeLoc       = 0x02, /* Functions or name of one loc changed, see ChangeLocGet(). */
+        cliChangeAc        = 0x04,
+        cliChangeEmergency = 0x08,
+        cliChangeNetwork   = 0x10, /* See NetworkChangeGet() for the impact. */
+        cliChangeAdc       = 0x20,
+        cliChangeXpNet     = 0x40
+    };
+
+#if APP_CFG_UC == APP_CFG_UC_ESP8266
+    /* Impact of changed network settings. */
+    enum networkChange
+    {
+        networkChangeNone = 0x00,
+        networkChangeZ21  = 0x01, /* Only Z21 target changed, Wifi connection can be kept. */
+        networkChangeIp   = 0x02, /* IP stack settings changed, restart IP with actual Wifi association. */
+        networkChangeWifi = 0x04  /* SSID or password changed, new Wifi association required. */
+    };
+#endif
+
+    /* Returned by NextDeadlineGet() when the cli only has to run when data is received. */
+    static const uint32_t NoDeadline = 0xFFFFFFFF;
+
     /* Constructor */
     WmcCli();
 
@@ -44,14 +214,87 @@ public:
      */
     void Update(void);
 
+    /**
+     * Get time in ms until Update() must be called again when no data is received, 0 when data is received and
+     * NoDeadline when the cli is idle.
+     */
+    uint32_t NextDeadlineGet(void);
+
 #if APP_CFG_UC == APP_CFG_UC_ESP8266
     /**
      * Default IP settings.
      */
     void IpSettingsDefault(void);
+
+    /**
+     * Get impact of network changes of the last cli event so only the required part of the network is restarted.
+     */
+    uint8_t NetworkChangeGet(void);
+
+    /**
+     * Wait until the next deadline of the cli or MaxTime (ms) has elapsed, at most until half of the receive buffer
+     * can be filled. Returns at once when received data is waiting. The wait yields to the SDK, so the Wifi sleep mode
+     * (modem or light sleep) set by the application can lower the power consumption.
+     */
+    void IdleWait(uint32_t MaxTime);
 #endif
 
+    /**
+     * Get data changed by the cli for the last cli event, so only changed data has to be reloaded.
+     */
+    uint8_t ChangeGet(void);
+
+    /**
+     * Get address of the changed loc when ChangeGet() contains cliChangeLoc.
+     */
+    uint16_t ChangeLocGet(void);
+
+    /**
+     * Get roster generation, changes each time locs are added, deleted or changed.
+     */
+    uint16_t RosterGenerationGet(void);
+
+    /**
+     * Store checksum of data regions changed outside the cli (cliChange mask). The application must call this after
+     * it wrote locs or settings itself, a region with a wrong checksum is reported as corrupt at the next start.
+     */
+    void IntegritySeal(uint8_t Change);
+
+    /**
+     * Invalidate the loc address index, required when locs are added, deleted or changed outside the cli.
+     */
+    void LocIndexInvalidate(void);
+
 private:
+    /* Buffers of commands which never run at the same time. Macro recording, import and calibration take all received
+     * data until they are finished, so their buffers can share memory with the buffers of single commands. */
+    union scratchBuffer
+    {
+#if APP_CFG_UC == APP_CFG_UC_ESP8266
+        struct
+        {
+            char SsidName[40];
+            char SsidPassword[64];
+            uint8_t IpAddress[4];
+        } Network;
+        uint16_t CalibrateValues[7];
+#endif
+#if WMC_CLI_MODULE_MACRO == 1
+        uint8_t MacroBuffer[64];
+#endif
+#if WMC_CLI_MODULE_IMPORT == 1
+        struct
+        {
+            char Tag[20];
+            char Attribute[12];
+            char Value[WMC_CLI_NAME_LENGTH + 1];
+            char Name[WMC_CLI_NAME_LENGTH + 1];
+            char Entity[6];
+        } Import;
+#endif
+        uint8_t Unused;
+    };
+
     /**
      * Check an process received command.
      */
@@ -61,52 +304,260 @@ private:
      * Show help screen.
      */
     void HelpScreen(void);
-#if APP_CFG_UC == APP_CFG_UC_ESP8266
+
+    /**
+     * Lower deadline to the remaining time of a delay started at StartTime.
+     */
+    void DeadlineUpdate(uint32_t* DeadlinePtr, uint32_t StartTime, uint32_t Delay);
+
+    /**
+     * Collect changed data for the next cli event.
+     */
+    void ChangeSet(uint8_t Change, uint16_t Address = 0);
+
+    /**
+     * Send one cli event for all changes when no more commands are received.
+     */
+    void ChangeEventUpdate(void);
+
+    /**
+     * Erase all locs and restore default settings.
+     */
+    void EraseAllData(void);
+
+#if WMC_CLI_MODULE_IMPORT == 1
+    /**
+     * Process a received character of a roster import.
+     */
+    void ImportChar(char Data);
+
+    /**
+     * Handle a complete tag name of the imported XML data.
+     */
+    void ImportTag(bool Closed);
+
+    /**
+     * Handle an attribute of the imported XML data.
+     */
+    void ImportAttribute(void);
+
+    /**
+     * Add or update the imported loc.
+     */
+    void ImportLocStore(void);
+
+    /**
+     * Stop import and sort loc table.
+     */
+    void ImportEnd(void);
+#endif
+
+    /**
+     * Handle baud rate switch and its confirmation.
+     */
+    void BaudCommand(void);
+
+    /**
+     * Switch back to default baud rate when new baud rate is not confirmed in time.
+     */
+    void BaudUpdate(void);
+
+    /**
+     * Show or select the flow control.
+     */
+    void FlowCommand(void);
+
+    /**
+     * Stop the host sending data while a command or commit is executed.
+     */
+    void FlowStop(void);
+
+    /**
+     * Allow the host to send data again.
+     */
+    void FlowStart(void);
+
+    /**
+     * Allow the host to send data also when the flow is not stopped, the host may have missed the start while the
+     * baud rate changed.
+     */
+    void FlowRelease(void);
+
+    /**
+     * Show all or the requested settings.
+     */
+    void SettingsGet(void);
+
+    /**
+     * Write a setting received by the set command.
+     */
+    void SettingsSet(void);
+
     /**
-     * Write SSID name.
+     * Write a setting and inform the application about the change.
      */
-    void SsIdWriteName(void);
+    void SettingApply(const char* KeyPtr, const char* ValuePtr);
 
     /**
-     * Write SSID password.
+     * Find setting in settings table, 255 if not present.
      */
-    void SsIdWritePassword(void);
+    uint8_t SettingFind(const char* KeyPtr, uint8_t Length);
 
     /**
-     * Write IP address to connect to.
+     * Check and write setting value.
      */
-    bool IpAddressWriteZ21(void);
+    bool SettingWrite(uint8_t Index, const char* ValuePtr);
 
+    /**
+     * Print setting as key and value.
+     */
+    void SettingPrint(uint8_t Index);
+#if APP_CFG_UC == APP_CFG_UC_ESP8266
     /**
      * Show programmed IP settings.
      */
     void ShowNetworkSettings(void);
+
+    /**
+     * Stage a network change, the changes are applied together when no more commands are received.
+     */
+    void NetworkChangeSet(uint8_t Change);
+
+    /**
+     * Apply staged network changes and measure the reconnect time.
+     */
+    void NetworkChangeUpdate(void);
 #endif
     /**
      * Try to add loc.
      */
     bool Add(void);
 
+    /**
+     * Add loc with given address.
+     */
+    bool AddExecute(uint16_t Address);
+
     /**
      * Try to delete loc.
      */
     bool Delete(void);
 
+    /**
+     * Delete loc with given address.
+     */
+    bool DeleteExecute(uint16_t Address);
+
     /**
      * Change loc data (function assignment).
      */
     bool Change(void);
 
+    /**
+     * Assign function to button of loc with given address.
+     */
+    bool ChangeExecute(uint16_t Address, uint16_t Button, uint16_t Function);
+
+    /**
+     * Get last address of an address range like 100-199, returns false if no range is present.
+     */
+    bool RangeGet(const char* StrPtr, uint16_t* LastPtr);
+
+    /**
+     * Delete all locs within address range.
+     */
+    bool DeleteRange(uint16_t First, uint16_t Last);
+
+    /**
+     * Assign function to button of all locs within address range.
+     */
+    bool ChangeRange(uint16_t First, uint16_t Last, uint16_t Button, uint16_t Function);
+
+    /**
+     * Set name of all locs within address range, with prefix the address is added to the name.
+     */
+    bool SetNameRange(uint16_t First, uint16_t Last, const char* NamePtr);
+
+    /**
+     * Show result of a range command, the roster change is reported when a loc was changed.
+     */
+    void RangeReport(const char* ActionPtr, uint16_t NumberOfLocs, uint16_t NumberOfFailures, uint32_t StartTime);
+
     /**
      * List programmed locs.
      */
     void ListAllLocs(void);
 
+    /**
+     * Get name of loc, the long name of the name pool when it belongs to the name stored by the loc lib. Returns the
+     * length of the name.
+     */
+    uint8_t NameGet(LocLibData* DataPtr, char* NamePtr);
+
+    /**
+     * Store the long name of a loc in the name pool, after the loc lib stored the name. Returns the number of stored
+     * characters.
+     */
+    uint8_t NamePoolStore(uint16_t Address, const char* NamePtr);
+
+    /**
+     * Get the number of used bytes of the name pool, a corrupted pool is cleared. The entries are walked to validate
+     * the pool, so each operation reads it once and passes it to the other name pool functions.
+     */
+    uint16_t NamePoolUsedGet(void);
+
+    /**
+     * Set the number of used bytes of the name pool.
+     */
+    void NamePoolUsedSet(uint16_t Used);
+
+    /**
+     * Get the offset of the entry of a loc (Address > 0) or of a prefix (Address 0), NamePoolNotFound if not present.
+     */
+    uint16_t NamePoolFind(uint16_t Used, uint16_t Address, uint8_t Prefix);
+
+    /**
+     * Get the size in bytes of an entry.
+     */
+    uint8_t NamePoolEntrySize(uint16_t Offset);
+
+    /**
+     * Decode the text of an entry including its prefix. Returns the length of the text.
+     */
+    uint8_t NamePoolDecode(uint16_t Used, uint16_t Offset, char* NamePtr);
+
+    /**
+     * Get the prefix entry of the first Length characters of a name, the entry is created when another name in the pool
+     * starts with the same characters. Returns 0 when no prefix is used, UsedPtr is updated.
+     */
+    uint8_t NamePoolPrefixGet(uint16_t* UsedPtr, const char* TextPtr, uint8_t Length);
+
+    /**
+     * Encode and add an entry to the name pool, UsedPtr is updated.
+     */
+    bool NamePoolAppend(uint16_t* UsedPtr, uint16_t Address, uint8_t Prefix, const char* TextPtr, uint8_t Length);
+
+    /**
+     * Remove an entry from the name pool, UsedPtr is updated.
+     */
+    void NamePoolRemove(uint16_t* UsedPtr, uint16_t Offset);
+
+    /**
+     * Remove entries of locs which are not present or renamed outside the cli and prefixes without any reference,
+     * UsedPtr is updated.
+     */
+    void NamePoolCompact(uint16_t* UsedPtr);
+
     /**
      * Set name of loc.
      */
     bool SetName(void);
 
+    /**
+     * Set name of loc with given address.
+     */
+    bool SetNameExecute(uint16_t Address, const char* NamePtr);
+
     /**
      * Set control type, normal or AC.
      */
@@ -117,27 +568,166 @@ private:
      */
     bool EmergencyChange(void);
 
-#if APP_CFG_UC == APP_CFG_UC_ESP8266
+#if WMC_CLI_MODULE_MACRO == 1
+    /**
+     * Handle the macro record / end / abort / run / list / del commands.
+     */
+    bool MacroCommand(void);
+
+    /**
+     * Convert received command to bytecode and add it to the macro being recorded.
+     */
+    bool MacroRecordLine(void);
+
+    /**
+     * Get address argument of a macro command, $1..$4 is stored as argument reference.
+     */
+    uint16_t MacroArgGet(const char* StrPtr);
+
+    /**
+     * Find EEPROM slot of macro with given name, 255 if not present.
+     */
+    uint8_t MacroSlotFind(const char* NamePtr);
+
+    /**
+     * Execute the bytecode of a stored macro.
+     */
+    bool MacroRun(uint8_t Slot, uint16_t* ArgsPtr, uint8_t NumberOfArgs);
+
+    /**
+     * Show names of stored macros.
+     */
+    void MacroList(void);
+#endif
+
+#if WMC_CLI_MODULE_PROFILE == 1
+    /**
+     * Handle the profile save / load / list / delete commands.
+     */
+    void ProfileCommand(void);
+
+    /**
+     * Find EEPROM slot of profile with given name, 255 if not present. Without name a free slot is searched.
+     */
+    uint8_t ProfileSlotFind(const char* NamePtr);
+
+    /**
+     * Store all locs in a profile slot.
+     */
+    bool ProfileSave(uint8_t Slot, const char* NamePtr);
+
+    /**
+     * Replace all locs by the locs of a profile slot.
+     */
+    bool ProfileLoad(uint8_t Slot);
+
+    /**
+     * Show stored profiles, the active profile is marked.
+     */
+    void ProfileList(void);
+#endif
+
+#if (WMC_CLI_MODULE_PROFILE == 1) || (WMC_CLI_MODULE_UNDO == 1)
+    /**
+     * Store all locs as loc records of a profile in the EEPROM.
+     */
+    void RosterStore(uint16_t Address);
+
+    /**
+     * Check the loc records of a profile in the EEPROM.
+     */
+    bool RosterRecordsValid(uint16_t Address, uint8_t NumberOfLocs);
+
+    /**
+     * Check if a loc address is present in the loc records of a profile in the EEPROM.
+     */
+    bool RosterRecordFind(uint16_t Address, uint8_t NumberOfLocs, uint16_t LocAddress);
+
+    /**
+     * Make the roster equal to the checked loc records of a profile in the EEPROM.
+     */
+    bool RosterLoad(uint16_t Address, uint8_t NumberOfLocs);
+#endif
+
+    /**
+     * Add the inverse of a loc change to the undo journal, DataPtr is the loc data before the change.
+     */
+    void UndoRecord(uint8_t Op, uint16_t Address, LocLibData* DataPtr);
+
+#if WMC_CLI_MODULE_UNDO == 1
+    /**
+     * Revert the last n commands which changed locs.
+     */
+    void UndoCommand(void);
+
+    /**
+     * Revert the last command in the undo journal, false if the journal is empty.
+     */
+    bool UndoGroup(void);
+
+    /**
+     * Show the commands in the undo journal, last command first.
+     */
+    void UndoHistory(void);
+
+    /**
+     * Clear undo journal.
+     */
+    void UndoClear(void);
+
+    /**
+     * Get head and number of records of the undo journal, false if the journal was invalid and is cleared.
+     */
+    bool UndoHeaderGet(uint8_t* HeadPtr, uint8_t* CountPtr);
+
+    /**
+     * Get the tag of the roster in the undo snapshot.
+     */
+    uint16_t UndoSnapshotTagGet(void);
+
+    /**
+     * Store all locs in the undo snapshot, false if there are too many locs.
+     */
+    bool UndoSnapshotSave(uint16_t* TagPtr);
+
+    /**
+     * Replace all locs by the locs of the undo snapshot if it still contains the roster of the clear.
+     */
+    bool UndoSnapshotRestore(uint16_t Tag);
+#endif
+
     /**
-     * Toggle between static and dynamic ip address.
+     * Commit EEPROM data (only required on the ESP8266).
      */
-    bool StaticIpChange(void);
+    void EepCommit(void);
 
     /**
-     * Write fixed (static) IP address of WMC.
+     * Check if the cli EEPROM area fits in the EEPROM, otherwise the command is refused.
+     */
+    bool CliEepAvailable(void);
+
+#if APP_CFG_UC == APP_CFG_UC_ESP8266
+    /**
+     * Handle a line received during button calibration, measure the actual step or abort.
      */
-    bool IpAddressWriteWmc(void);
+    void CalibrateStep(void);
 
     /**
-     * Write IP gateway of WMC.
+     * Show instruction for the actual calibration step.
      */
-    bool IpAddressWriteGateway(void);
+    void CalibratePrompt(void);
 
     /**
-     * Write IP subnet of WMC.
+     * Get median of oversampled ADC values, false if the values are not stable.
      */
-    bool IpAddressWriteSubnet(void);
+    bool CalibrateMeasure(uint16_t* ValuePtr);
 
+    /**
+     * Check margin between the measured values and store them.
+     */
+    void CalibrateStore(void);
+#endif
+#if (APP_CFG_UC == APP_CFG_UC_ESP8266) && (WMC_CLI_MODULE_DIAGNOSTICS == 1)
     /**
      * Show ADC data of buttons.
      */
@@ -148,6 +738,156 @@ private:
      */
     void DumpData(void);
 
+    /**
+     * Get index of loc in loc table, LocIndexNotFound if not present.
+     */
+    uint16_t LocIndexFind(uint16_t Address);
+
+#if WMC_CLI_LOC_INDEX_SIZE > 0
+    /**
+     * Build the loc address index from the sorted loc table.
+     */
+    bool LocIndexBuild(void);
+
+    /**
+     * Get the first index entry to probe for an address.
+     */
+    uint16_t LocIndexHash(uint16_t Address);
+#endif
+
+    /**
+     * Update the loc address index after a single loc is added.
+     */
+    void LocIndexInsert(uint16_t Address);
+
+    /**
+     * Update the loc address index after a single loc is deleted.
+     */
+    void LocIndexRemove(uint16_t Address, uint16_t Index);
+
+#if WMC_CLI_MODULE_SYNC == 1
+    /**
+     * Handle sync commands, report loc hashes or apply a complete loc record.
+     */
+    bool SyncCommand(void);
+
+    /**
+     * Add or update a complete loc record received by the sync loc command.
+     */
+    bool SyncLoc(char* DataPtr);
+#endif
+
+    /**
+     * Get hash of a loc record.
+     */
+    uint32_t LocRecordHash(LocLibData* DataPtr);
+
+#if WMC_CLI_MODULE_DIAGNOSTICS == 1
+    /**
+     * Handle checksum command, show checksum of loc table and settings.
+     */
+    void ChecksumCommand(void);
+
+    /**
+     * Measure duration of EEPROM, serial, loc table and command dispatch operations.
+     */
+    void BenchCommand(void);
+
+    /**
+     * Sort measured durations and get operations per second and latency percentiles.
+     */
+    void BenchSummarize(uint32_t* SamplesPtr, uint8_t NumberOfSamples, uint8_t OpsPerSample, uint32_t* ResultPtr);
+
+    /**
+     * Handle the raw EEPROM read and write commands.
+     */
+    void EepCommand(void);
+
+    /**
+     * Check if an address range is within one writable region, get the changed data of the region.
+     */
+    bool EepWriteAllowed(uint16_t Address, uint16_t Length, uint8_t* ChangePtr, uint8_t* NetworkChangePtr);
+#endif
+
+#if WMC_CLI_MODULE_TRACE == 1
+    /**
+     * Handle trace dump and clear commands.
+     */
+    void TraceCommand(void);
+#endif
+
+    /**
+     * Add event to the trace ring, oldest entry is overwritten when the ring is full.
+     */
+    void Trace(uint8_t Id, uint16_t Data);
+
+    /**
+     * Calculate checksum of all locs.
+     */
+    void RosterChecksumCalculate(void);
+
+    /**
+     * Remove / add hash of loc from / to loc table checksum, call before and after changing a loc.
+     */
+    void LocChecksumToggle(uint16_t Address);
+
+    /**
+     * Calculate checksum of all stored settings.
+     */
+    void SettingsChecksumUpdate(void);
+
+    /**
+     * Check stored checksum of all data regions, optionally repair corrupt regions.
+     */
+    void IntegrityCheck(bool Print, bool Repair);
+
+    /**
+     * Calculate checksum of a data region.
+     */
+    uint32_t RegionCrc(uint8_t Region);
+
+    /**
+     * Write version and checksum of a data region (no commit).
+     */
+    void RegionSeal(uint8_t Region);
+
+    /**
+     * Write version and checksum of the regions of a cliChange mask and commit.
+     */
+    void ChangeSeal(uint8_t Change);
+
+    /**
+     * Check the values of a region against their allowed range.
+     */
+    bool RegionValid(uint8_t Region);
+
+    /**
+     * Restore the invalid values of a corrupt region, valid values are kept.
+     */
+    void RegionRepair(uint8_t Region);
+
+    /**
+     * Update CRC32 with data.
+     */
+    uint32_t Crc32Update(uint32_t Crc, const uint8_t* DataPtr, uint16_t Length);
+
+    /**
+     * Update CRC32 with a 32 bit value (big endian).
+     */
+    uint32_t Crc32Update32(uint32_t Crc, uint32_t Value);
+
+    /**
+     * Update CRC32 with EEPROM data.
+     */
+    uint32_t Crc32UpdateEep(uint32_t Crc, uint16_t Address, uint16_t Length);
+
+#if (WMC_CLI_MODULE_SYNC == 1) || (WMC_CLI_MODULE_DIAGNOSTICS == 1)
+    /**
+     * Print value as 8 digit hex number.
+     */
+    void PrintHex32(uint32_t Value);
+#endif
+
     /**
      * Show overview of settings.
      */
@@ -157,7 +897,7 @@ private:
     /**
      * Retrieve Ip data from string.
      */
-    bool IpGetData(const char* SourcePtr, uint8_t* TargetPtr);
+    bool IpGetData(const char* StrPtr, uint8_t* TargetPtr);
 
     /**
      * Print ip data.
@@ -169,18 +909,69 @@ private:
     LocStorage m_LocStorage;
     char m_bufferRx[75];
     uint16_t m_bufferRxIndex;
+    bool m_RxOverflow;
     uint16_t m_Address;
     uint16_t m_DecoderSteps;
     uint16_t m_Function;
     uint16_t m_Button;
-    char m_NameStr[10];
+    uint8_t m_Change;
+    uint8_t m_ChangePending;
+    uint8_t m_ChangeSeal;
+    uint16_t m_ChangeLoc;
+    uint16_t m_ChangeLocPending;
+    uint16_t m_RosterGeneration;
+    uint32_t m_RxTime;
+    uint32_t m_CommandTime;
+#if WMC_CLI_MODULE_MACRO == 1
+    bool m_MacroRecording;
+#endif
+    uint32_t m_RosterChecksum;
+    uint32_t m_SettingsChecksum;
+    uint16_t m_ChecksumNumberOfLocs;
+    uint8_t m_RegionCorrupt;
+    bool m_CliEepValid;
+#if WMC_CLI_MODULE_UNDO == 1
+    uint16_t m_UndoGroupSize;
+#endif
+#if WMC_CLI_MODULE_TRACE == 1
+    traceEntry m_Trace[WMC_CLI_TRACE_SIZE];
+    uint8_t m_TraceIndex;
+    uint8_t m_TraceNumberOfEntries;
+#endif
+#if WMC_CLI_LOC_INDEX_SIZE > 0
+    uint16_t m_LocIndex[WMC_CLI_LOC_INDEX_SIZE];
+    uint16_t m_LocIndexNumberOfLocs;
+    bool m_LocIndexValid;
+#endif
+#if WMC_CLI_MODULE_IMPORT == 1
+    bool m_ImportActive;
+    uint8_t m_ImportState;
+    char m_ImportQuote;
+    uint8_t m_ImportTagLength;
+    uint8_t m_ImportAttributeLength;
+    uint8_t m_ImportValueLength;
+    uint8_t m_ImportMarkupCount;
+    bool m_ImportTagClosed;
+    uint16_t m_ImportAddress;
+    uint8_t m_ImportFunctions[5];
+    uint8_t m_ImportNumberOfFunctions;
+    uint16_t m_ImportNumberOfLocs;
+    uint16_t m_ImportNumberOfFailures;
+    uint32_t m_ImportStartTime;
+#endif
+    scratchBuffer m_Scratch;
+    uint32_t m_BaudRate;
+    uint32_t m_BaudSwitchTime;
+    bool m_BaudPending;
+    uint8_t m_FlowControl;
+    bool m_FlowStopped;
 #if APP_CFG_UC == APP_CFG_UC_ESP8266
-    char m_SsidName[40];
-    char m_SsidPassword[64];
-    uint8_t m_IpAddressZ21[4];
-    uint8_t m_IpAddresWmc[4];
-    uint8_t m_IpGateway[4];
-    uint8_t m_IpSubnet[4];
+    uint8_t m_NetworkChange;
+    uint8_t m_NetworkChangeApplied;
+    uint32_t m_NetworkChangeTime;
+    bool m_NetworkReconnectPending;
+    bool m_NetworkDown;
+    uint8_t m_CalibrateStep;
 #endif
 
     static const char* LocAdd;
@@ -196,6 +987,37 @@ private:
     static const char* Dump;
     static const char* Settings;
     static const char* Reset;
+    static const char* Get;
+    static const char* Set;
+    static const char* Baud;
+    static const char* Flow;
+    static const char* Verify;
+    static const char* NamePoolCharacters;
+    static const char* NamePoolPunctuation;
+#if WMC_CLI_MODULE_MACRO == 1
+    static const char* Macro;
+#endif
+#if WMC_CLI_MODULE_IMPORT == 1
+    static const char* Import;
+#endif
+#if WMC_CLI_MODULE_PROFILE == 1
+    static const char* Profile;
+#endif
+#if WMC_CLI_MODULE_UNDO == 1
+    static const char* Undo;
+    static const char* History;
+#endif
+#if WMC_CLI_MODULE_SYNC == 1
+    static const char* Sync;
+#endif
+#if WMC_CLI_MODULE_DIAGNOSTICS == 1
+    static const char* Checksum;
+    static const char* Bench;
+    static const char* Eep;
+#endif
+#if WMC_CLI_MODULE_TRACE == 1
+    static const char* TraceCmd;
+#endif
 #if APP_CFG_UC == APP_CFG_UC_ESP8266
     static const char* Ssid;
     static const char* Password;
@@ -206,8 +1028,149 @@ private:
     static const char* Subnet;
     static const char* StaticIp;
     static const char* AdcInvalidate;
+    static const char* Calibrate;
+#if WMC_CLI_MODULE_DIAGNOSTICS == 1
     static const char* Buttons;
 #endif
+#endif
+
+    static const settingDescriptor SettingsTable[];
+    static const uint8_t SettingsTableSize;
+
+    static const uint8_t MacroSlots              = 4;
+    static const uint8_t MacroSlotSize           = 64;
+    static const uint8_t MacroNameLength         = 8;
+    static const uint8_t MacroCodeSizeOffset     = MacroNameLength;
+    static const uint8_t MacroCodeOffset         = MacroNameLength + 1;
+    static const uint16_t MacroArgReference      = 0x8000;
+    static const uint16_t MacroEepAddress        = WMC_CLI_EEP_ADDRESS;
+    static const uint16_t IntegrityEepAddress    = MacroEepAddress + (MacroSlots * MacroSlotSize);
+    static const uint8_t IntegrityVersion        = 1;
+    static const uint8_t IntegrityTableSize      = 32;
+    static const uint16_t ProfileEepAddress      = IntegrityEepAddress + IntegrityTableSize;
+    static const uint8_t ProfileNameLength       = 8;
+    static const uint8_t ProfileRecordSize       = 2 + 5 + sizeof(LocLibData::Name);
+    static const uint16_t ProfileSlotSize        = ProfileNameLength + 1 + (WMC_CLI_PROFILE_LOCS * ProfileRecordSize);
+    static const uint16_t UndoEepAddress         = ProfileEepAddress + 1 + (WMC_CLI_PROFILE_SLOTS * ProfileSlotSize);
+    static const uint8_t UndoRecordSize          = 1 + ProfileRecordSize;
+    static const uint8_t UndoGroupStart          = 0x80;
+    static const uint16_t UndoSnapshotEepAddress = UndoEepAddress + 2 + (WMC_CLI_UNDO_RECORDS * UndoRecordSize);
+    static const uint16_t UndoSnapshotSize       = 3 + (WMC_CLI_PROFILE_LOCS * ProfileRecordSize);
+    static const uint16_t NamePoolEepAddress     = UndoSnapshotEepAddress + UndoSnapshotSize;
+    static const uint8_t NamePoolSymbols         = 31;
+    static const uint8_t NamePoolPrefixLength    = 8;
+    static const uint8_t NamePoolPrefixes        = 7;
+    static const uint8_t NamePoolEscape          = 63;
+    static const uint16_t NamePoolNotFound       = 0xFFFF;
+    static const uint16_t CliEepEnd              = NamePoolEepAddress + WMC_CLI_NAME_POOL_SIZE;
+    static const uint8_t EepBytesPerLine         = 16;
+    static const uint16_t LocIndexNotFound       = 0xFFFF;
+    static const uint16_t LocIndexMask           = WMC_CLI_LOC_INDEX_SIZE - 1;
+    static const uint32_t ChangeEventDelay       = 100;
+    static const uint32_t ImportTimeout          = 10000;
+    static const uint32_t BaudRateDefault        = 115200;
+    static const uint32_t BaudConfirmTimeout     = 5000;
+    static const char FlowXon                    = 0x11;
+    static const char FlowXoff                   = 0x13;
+    static const uint8_t BenchSamples            = 32;
+    static const uint8_t BenchOps                = WMC_CLI_BENCH_OPS;
+#if APP_CFG_UC == APP_CFG_UC_ESP8266
+    static const uint32_t NetworkApplyDelay     = 250;
+    static const uint32_t NetworkReconnectLimit = 30000;
+    static const uint32_t NetworkPollInterval   = 100;
+    static const uint8_t CalibrateSamples       = 15;
+    static const uint16_t CalibrateSpreadLimit  = 16;
+    static const uint16_t CalibrateMargin       = 20;
+#endif
+
+    static_assert((CliEepEnd > WMC_CLI_EEP_ADDRESS) && (CliEepEnd <= WMC_CLI_EEP_SIZE),
+        "The cli EEPROM area does not fit in WMC_CLI_EEP_SIZE, reduce profiles, undo records or name pool.");
+
+#if WMC_CLI_MODULE_MACRO == 1
+    /* Bytecode of the macro commands. */
+    enum macroOpcode
+    {
+        macroOpAdd = 1,
+        macroOpDelete,
+        macroOpChange,
+        macroOpName,
+        macroOpAc,
+        macroOpEmergency
+    };
+#endif
+
+    /* Commands in the undo journal, add is reverted by deleting the loc, the others by restoring the stored loc. */
+    enum undoOpcode
+    {
+        undoOpAdd = 1,
+        undoOpDelete,
+        undoOpChange,
+        undoOpName,
+        undoOpClear /* All locs removed, one record with the tag of the roster in the snapshot area. */
+    };
+
+    /* Flow control of the serial port. */
+    enum flowControl
+    {
+        flowNone = 0,
+        flowXonXoff,
+        flowRts
+    };
+
+    /* Data regions protected by a version and checksum. */
+    enum region
+    {
+        regionRoster = 0,
+        regionOptions,
+#if APP_CFG_UC == APP_CFG_UC_ESP8266
+        regionNetwork,
+        regionAdc,
+#endif
+        regionCount
+    };
+
+    /* Events of the trace ring. */
+    enum traceId
+    {
+        traceCommandStart = 0, /* Data: first two characters of the command. */
+        traceCommandEnd,
+        traceEepCommit,
+        traceEvent,      /* Data: changed data. */
+        traceRxOverflow, /* Data: lost characters. */
+        traceCount
+    };
+
+#if WMC_CLI_MODULE_DIAGNOSTICS == 1
+    /* Operations measured by the bench command. */
+    enum benchTest
+    {
+        benchEepRead = 0,
+        benchEepWrite,
+        benchEepCommit,
+        benchSerialTx,
+        benchCheckLoc,
+        benchLocIndex,
+        benchLocData,
+        benchDispatch,
+        benchCount
+    };
+#endif
+
+#if WMC_CLI_MODULE_IMPORT == 1
+    /* States of the XML import parser. */
+    enum importState
+    {
+        importText = 0,
+        importTagName,
+        importAttributeName,
+        importAttributeQuote,
+        importAttributeValue,
+        importAttributeEntity,
+        importMarkup,
+        importComment,
+        importDeclaration
+    };
+#endif
 
     cliEnterEvent Event;
 };
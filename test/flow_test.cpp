@@ -0,0 +1,199 @@
+/***********************************************************************************************************************
+   @file  flow_test.cpp
+   @brief JMRI roster import over a serial line at 115200 baud with a slow loc storage. The receive buffer of the
+          STM32 (64 bytes) and the ESP8266 (512 bytes) overflows while a loc is stored unless the cli stops the host
+          with xon/xoff flow control, without flow control data must be lost or the test shows nothing. A baud rate
+          switch, its confirmation and its fallback must leave the host released on each baud rate.
+ **********************************************************************************************************************/
+
+/***********************************************************************************************************************
+   I N C L U D E S
+ **********************************************************************************************************************/
+#include "host.h"
+#include <string>
+
+/***********************************************************************************************************************
+   D A T A   D E C L A R A T I O N S (exported, local)
+ **********************************************************************************************************************/
+static const uint32_t BaudRate     = 115200;
+static const uint16_t StopLatency  = 16;    /* Bytes still sent after xoff, the transmit fifo of the host. */
+static const uint32_t StoreTime    = 20000; /* us for a loc store of the loc lib. */
+static const uint16_t NumberOfLocs = 40;
+
+/***********************************************************************************************************************
+   F U N C T I O N S
+ **********************************************************************************************************************/
+
+/***********************************************************************************************************************
+ * JMRI roster with a name and function labels for each loc.
+ */
+static std::string RosterGet(void)
+{
+    std::string Roster = "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\r\n<roster-config>\r\n<roster>\r\n";
+    char Loc[200];
+    uint16_t Index;
+
+    for (Index = 0; Index < NumberOfLocs; Index++)
+    {
+        snprintf(Loc, sizeof(Loc),
+            "<locomotive id=\"BR 218 %03u\" dccAddress=\"%u\">\r\n<functionlabels>\r\n"
+            "<functionlabel num=\"0\">Light</functionlabel>\r\n<functionlabel num=\"2\">Horn</functionlabel>\r\n"
+            "</functionlabels>\r\n</locomotive>\r\n",
+            (unsigned)(Index + 100), (unsigned)(Index + 100));
+        Roster += Loc;
+    }
+
+    Roster += "</roster>\r\n</roster-config>\r\n";
+    return (Roster);
+}
+
+/***********************************************************************************************************************
+ * Import the roster, return the number of dropped bytes.
+ */
+static uint32_t ImportRun(uint16_t FifoSize, const char* Flow, bool* CompletePtr)
+{
+    WmcCli Cli;
+    LocLib Lib;
+    LocStorage Storage;
+    std::string Output;
+    std::string Command = std::string("flow ") + Flow + "\r\n";
+    char Imported[40];
+    uint32_t Result;
+
+    HostUartModel(0, 0, 0);
+    HostStorageDelay(0, 0);
+    Cli.Init(Lib, Storage);
+    HostInput(Command);
+    HostInput("clear\r\n");
+    HostRun(Cli);
+    HostOutput();
+
+    HostUartModel(BaudRate, FifoSize, StopLatency);
+    HostStorageDelay(StoreTime, 0);
+    HostInput("import\r\n");
+    HostInput(RosterGet());
+    HostRun(Cli);
+    Output = HostOutput();
+    Result = HostDroppedGet();
+
+    snprintf(Imported, sizeof(Imported), "%u locs imported, 0 failed", (unsigned)(NumberOfLocs));
+    *CompletePtr = (Output.find(Imported) != std::string::npos);
+
+    HostUartModel(0, 0, 0);
+    HostStorageDelay(0, 0);
+    return (Result);
+}
+
+/***********************************************************************************************************************
+ * Get the last flow control character sent, 0 if none.
+ */
+static char FlowLastGet(const std::string& Output)
+{
+    size_t Position = Output.find_last_of("\x11\x13");
+
+    return ((Position != std::string::npos) ? Output[Position] : 0);
+}
+
+/***********************************************************************************************************************
+ * Switch the baud rate with flow xon, confirm it or wait for the fallback. The data sent at each baud rate must end
+ * with xon, else a host on that rate stays stopped.
+ */
+static uint32_t BaudRun(bool Confirm)
+{
+    WmcCli Cli;
+    LocLib Lib;
+    LocStorage Storage;
+    std::string Output;
+    size_t Start = 0;
+    size_t End;
+    uint32_t Failures = 0;
+    uint8_t Rate      = 0;
+    uint8_t Second;
+
+    Cli.Init(Lib, Storage);
+    HostInput("flow xon\r\n");
+    HostRun(Cli);
+    HostOutput();
+
+    HostBaudMarkSet(true);
+    HostInput("baud 230400\r\n");
+    HostRun(Cli);
+    if (Confirm == true)
+    {
+        HostInput("baud ok\r\n");
+        HostRun(Cli);
+    }
+    else
+    {
+        for (Second = 0; Second < 6; Second++)
+        {
+            HostRun(Cli);
+        }
+    }
+    Output = HostOutput();
+    HostBaudMarkSet(false);
+
+    do
+    {
+        End = Output.find("<begin ", Start);
+        if (FlowLastGet(Output.substr(Start, End - Start)) != 0x11)
+        {
+            printf("baud %s: host stopped at baud rate %u\n", (Confirm == true) ? "ok" : "fallback", Rate);
+            Failures++;
+        }
+        Start = (End != std::string::npos) ? Output.find('>', End) + 1 : End;
+        Rate++;
+    } while (End != std::string::npos);
+
+    if ((Confirm == true) && (Output.find('\x11', Output.find("230400 active.")) == std::string::npos))
+    {
+        printf("baud ok: no xon after the confirmation\n");
+        Failures++;
+    }
+
+    printf("baud %-8s %u baud rates, %s\n", (Confirm == true) ? "ok" : "fallback", Rate,
+        (Failures == 0) ? "host released on each" : "failed");
+
+    HostInput("flow none\r\nbaud 115200\r\n");
+    HostRun(Cli);
+    HostOutput();
+    return (Failures);
+}
+
+/***********************************************************************************************************************
+ */
+int main(void)
+{
+    static const uint16_t FifoSizes[] = { 64, 512 };
+    uint32_t Failures                 = 0;
+    uint32_t Dropped;
+    uint8_t Index;
+    bool Complete;
+
+    printf("Fifo  flow  dropped bytes  all locs\n");
+    for (Index = 0; Index < (sizeof(FifoSizes) / sizeof(FifoSizes[0])); Index++)
+    {
+        /* With flow control every byte arrives and every loc is imported. */
+        Dropped = ImportRun(FifoSizes[Index], "xon", &Complete);
+        printf("%4u  xon   %13u  %8s\n", FifoSizes[Index], Dropped, (Complete == true) ? "yes" : "no");
+        if ((Dropped != 0) || (Complete == false))
+        {
+            printf("import with xon and a fifo of %u bytes failed\n", FifoSizes[Index]);
+            Failures++;
+        }
+
+        /* Without flow control the line model must lose data, else the store is not slow enough for this test. */
+        Dropped = ImportRun(FifoSizes[Index], "none", &Complete);
+        printf("%4u  none  %13u  %8s\n", FifoSizes[Index], Dropped, (Complete == true) ? "yes" : "no");
+        if (Dropped == 0)
+        {
+            printf("import without flow control and a fifo of %u bytes lost no data\n", FifoSizes[Index]);
+            Failures++;
+        }
+    }
+
+    Failures += BaudRun(true);
+    Failures += BaudRun(false);
+
+    return (Failures == 0) ? 0 : 1;
+}
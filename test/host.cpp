@@ -0,0 +1,550 @@
+/***********************************************************************************************************************
+   @file  host.cpp
+   @brief Host model of the hardware used by the cli tests.
+ **********************************************************************************************************************/
+
+/***********************************************************************************************************************
+   I N C L U D E S
+ **********************************************************************************************************************/
+#include "host.h"
+#include <EEPROM.h>
+#include <ESP8266WiFi.h>
+#include <algorithm>
+#include <chrono>
+#include <deque>
+#include <utility>
+
+/***********************************************************************************************************************
+   D A T A   D E C L A R A T I O N S (exported, local)
+ **********************************************************************************************************************/
+HardwareSerial Serial;
+EEPROMClass EEPROM;
+ESP8266WiFiClass WiFi;
+uint32_t LocLib::m_StorageReads  = 0;
+uint32_t LocLib::m_StorageWrites = 0;
+std::vector<LocLibData> LocLib::m_Locs;
+
+static std::deque<uint8_t> HostRx;
+static std::deque<uint8_t> HostLine;
+static std::deque<std::pair<unsigned long, std::string> > HostSchedule;
+static std::string HostTx;
+static unsigned long HostMicros                        = 0;
+static bool HostReal                                   = false;
+static uint32_t HostCommits                            = 0;
+static std::chrono::steady_clock::time_point HostStart = std::chrono::steady_clock::now();
+static uint32_t HostByteTime                           = 0;
+static uint16_t HostFifoSize                           = 0;
+static uint16_t HostStopLatency                        = 0;
+static uint16_t HostStopCount                          = 0;
+static bool HostStopPending                            = false;
+static bool HostStopped                                = false;
+static unsigned long HostLineTime                      = 0;
+static uint32_t HostDropped                            = 0;
+static uint32_t HostStoreTime                          = 0;
+static uint32_t HostCommitTime                         = 0;
+static bool HostBaudMark                               = false;
+static uint16_t HostStoreFailAddress                   = 0;
+
+/***********************************************************************************************************************
+   F U N C T I O N S
+ **********************************************************************************************************************/
+
+/***********************************************************************************************************************
+ */
+void HostInput(const std::string& Data)
+{
+    if (HostByteTime == 0)
+    {
+        HostRx.insert(HostRx.end(), Data.begin(), Data.end());
+    }
+    else
+    {
+        /* An idle line starts sending now. */
+        if (HostLine.empty() == true)
+        {
+            HostLineTime = HostMicros;
+        }
+        HostLine.insert(HostLine.end(), Data.begin(), Data.end());
+    }
+}
+
+/***********************************************************************************************************************
+ */
+void HostInputAt(unsigned long Time, const std::string& Data)
+{
+    HostSchedule.push_back(std::make_pair(Time, Data));
+}
+
+/***********************************************************************************************************************
+ * Move the bytes which arrived until the given time from the line to the receive buffer.
+ */
+static void HostUartMove(unsigned long Until)
+{
+    while ((HostLine.empty() == false) && (HostStopped == false) && ((HostLineTime + HostByteTime) <= Until))
+    {
+        if (HostRx.size() < HostFifoSize)
+        {
+            HostRx.push_back(HostLine.front());
+        }
+        else
+        {
+            HostDropped++;
+        }
+        HostLine.pop_front();
+        HostLineTime += HostByteTime;
+
+        if (HostStopPending == true)
+        {
+            HostStopCount++;
+            HostStopped = (HostStopCount >= HostStopLatency);
+        }
+    }
+
+    if (HostLine.empty() == true)
+    {
+        HostLineTime = Until;
+    }
+}
+
+/***********************************************************************************************************************
+ * Send the scheduled data which is due and move the bytes which arrived until now to the receive buffer.
+ */
+static void HostUartUpdate(void)
+{
+    while ((HostSchedule.empty() == false) && (HostSchedule.front().first <= HostMicros))
+    {
+        HostUartMove(HostSchedule.front().first);
+        HostLine.insert(HostLine.end(), HostSchedule.front().second.begin(), HostSchedule.front().second.end());
+        HostSchedule.pop_front();
+    }
+
+    HostUartMove(HostMicros);
+}
+
+/***********************************************************************************************************************
+ */
+std::string HostOutput(void)
+{
+    std::string Result = HostTx;
+
+    HostTx.clear();
+
+    return (Result);
+}
+
+/***********************************************************************************************************************
+ */
+void HostRun(WmcCli& Cli)
+{
+    uint16_t Idle = 0;
+
+    /* Some more updates after the last data so pending events are sent. */
+    while (Idle < 1000)
+    {
+        if ((HostRx.empty() == true) && (HostLine.empty() == true) && (HostSchedule.empty() == true))
+        {
+            Idle++;
+        }
+        else
+        {
+            Idle = 0;
+        }
+        Cli.Update();
+        HostMicros += 1000;
+    }
+}
+
+/***********************************************************************************************************************
+ */
+void HostClockReal(bool Real)
+{
+    HostReal = Real;
+}
+
+/***********************************************************************************************************************
+ */
+uint32_t HostCommitsGet(void)
+{
+    return (HostCommits);
+}
+
+/***********************************************************************************************************************
+ */
+void HostUartModel(uint32_t Baud, uint16_t FifoSize, uint16_t StopLatency)
+{
+    /* 10 bits per byte: start bit, 8 data bits and stop bit. */
+    HostByteTime    = (Baud > 0) ? (10000000UL + Baud - 1) / Baud : 0;
+    HostFifoSize    = FifoSize;
+    HostStopLatency = StopLatency;
+    HostStopPending = false;
+    HostStopped     = false;
+    HostDropped     = 0;
+    HostLineTime    = HostMicros;
+}
+
+/***********************************************************************************************************************
+ */
+void HostBaudMarkSet(bool Mark)
+{
+    HostBaudMark = Mark;
+}
+
+/***********************************************************************************************************************
+ */
+uint32_t HostDroppedGet(void)
+{
+    return (HostDropped);
+}
+
+/***********************************************************************************************************************
+ */
+void HostStorageDelay(uint32_t StoreTime, uint32_t CommitTime)
+{
+    HostStoreTime  = StoreTime;
+    HostCommitTime = CommitTime;
+}
+
+/***********************************************************************************************************************
+ */
+void HostStoreFail(uint16_t Address)
+{
+    HostStoreFailAddress = Address;
+}
+
+/***********************************************************************************************************************
+ */
+unsigned long micros(void)
+{
+    unsigned long Result = HostMicros;
+    std::chrono::steady_clock::duration Elapsed;
+
+    if (HostReal == true)
+    {
+        Elapsed = std::chrono::steady_clock::now() - HostStart;
+        Result  = (unsigned long)(std::chrono::duration_cast<std::chrono::microseconds>(Elapsed).count());
+    }
+
+    return (Result);
+}
+
+/***********************************************************************************************************************
+ */
+unsigned long millis(void)
+{
+    return (micros() / 1000);
+}
+
+/***********************************************************************************************************************
+ */
+void delay(unsigned long Time)
+{
+    HostMicros += Time * 1000;
+}
+
+/***********************************************************************************************************************
+ */
+void yield(void)
+{
+}
+
+/***********************************************************************************************************************
+ */
+int analogRead(uint8_t Pin)
+{
+    return (1023);
+}
+
+/***********************************************************************************************************************
+ */
+void pinMode(uint8_t Pin, uint8_t Mode)
+{
+}
+
+/***********************************************************************************************************************
+ */
+void digitalWrite(uint8_t Pin, uint8_t Value)
+{
+}
+
+/***********************************************************************************************************************
+ */
+void nvic_sys_reset(void)
+{
+}
+
+/***********************************************************************************************************************
+ */
+bool EEPROMClass::commit(void)
+{
+    memcpy(m_Flash, m_Data, sizeof(m_Flash));
+    HostCommits++;
+    HostMicros += HostCommitTime;
+    return (true);
+}
+
+/***********************************************************************************************************************
+ */
+void HardwareSerial::begin(unsigned long Baud)
+{
+    char Mark[24];
+
+    if (HostBaudMark == true)
+    {
+        snprintf(Mark, sizeof(Mark), "<begin %lu>", Baud);
+        HostTx += Mark;
+    }
+}
+
+/***********************************************************************************************************************
+ */
+void HardwareSerial::end(void)
+{
+}
+
+/***********************************************************************************************************************
+ */
+void HardwareSerial::flush(void)
+{
+}
+
+/***********************************************************************************************************************
+ */
+int HardwareSerial::read(void)
+{
+    int Result = -1;
+
+    HostUartUpdate();
+    if (HostRx.empty() == false)
+    {
+        Result = HostRx.front();
+        HostRx.pop_front();
+    }
+
+    return (Result);
+}
+
+/***********************************************************************************************************************
+ */
+int HardwareSerial::available(void)
+{
+    HostUartUpdate();
+    return ((int)(HostRx.size()));
+}
+
+/***********************************************************************************************************************
+ */
+size_t HardwareSerial::setRxBufferSize(size_t Size)
+{
+    return (Size);
+}
+
+/***********************************************************************************************************************
+ */
+size_t HardwareSerial::write(uint8_t Data)
+{
+    /* The host reacts on XOFF after the stop latency, on XON at once. */
+    if (HostByteTime != 0)
+    {
+        HostUartUpdate();
+        if (Data == 0x13)
+        {
+            HostStopPending = true;
+            HostStopCount   = 0;
+            HostStopped     = (HostStopLatency == 0);
+        }
+        else if (Data == 0x11)
+        {
+            HostStopPending = false;
+            HostStopped     = false;
+            HostLineTime    = HostMicros;
+        }
+    }
+    HostTx.push_back((char)(Data));
+    return (1);
+}
+
+/***********************************************************************************************************************
+ */
+size_t HardwareSerial::write(const uint8_t* DataPtr, size_t Length)
+{
+    HostTx.append((const char*)(DataPtr), Length);
+    return (Length);
+}
+
+/***********************************************************************************************************************
+ */
+size_t HardwareSerial::print(const char* StrPtr)
+{
+    return (write((const uint8_t*)(StrPtr), strlen(StrPtr)));
+}
+
+/***********************************************************************************************************************
+ */
+size_t HardwareSerial::print(char Character)
+{
+    return (write((uint8_t)(Character)));
+}
+
+/***********************************************************************************************************************
+ */
+size_t HardwareSerial::print(unsigned char Value, int Base)
+{
+    return (print((unsigned long)(Value), Base));
+}
+
+/***********************************************************************************************************************
+ */
+size_t HardwareSerial::print(int Value, int Base)
+{
+    return (print((long)(Value), Base));
+}
+
+/***********************************************************************************************************************
+ */
+size_t HardwareSerial::print(unsigned int Value, int Base)
+{
+    return (print((unsigned long)(Value), Base));
+}
+
+/***********************************************************************************************************************
+ */
+size_t HardwareSerial::print(long Value, int Base)
+{
+    size_t Result = 0;
+
+    if ((Value < 0) && (Base == DEC))
+    {
+        Result = print('-') + print((unsigned long)(-Value), Base);
+    }
+    else
+    {
+        Result = print((unsigned long)(Value), Base);
+    }
+
+    return (Result);
+}
+
+/***********************************************************************************************************************
+ */
+size_t HardwareSerial::print(unsigned long Value, int Base)
+{
+    char Output[24];
+
+    snprintf(Output, sizeof(Output), (Base == HEX) ? "%lX" : "%lu", Value);
+
+    return (print(Output));
+}
+
+/***********************************************************************************************************************
+ */
+size_t HardwareSerial::println(void)
+{
+    return (print("\r\n"));
+}
+
+/***********************************************************************************************************************
+ */
+bool LocLib::StoreLoc(uint16_t Address, uint8_t* FunctionsPtr, char* NamePtr, store Store)
+{
+    uint8_t Index = CheckLoc(Address);
+    bool Result   = false;
+    LocLibData Data;
+
+    if ((Address != 0) && (Address == HostStoreFailAddress))
+    {
+        /* Write error of the storage, nothing changed. */
+    }
+    else if ((Store != storeChange) && (Index == 255) && (m_Locs.size() < 254))
+    {
+        memset(&Data, 0, sizeof(Data));
+        Data.Addres = Address;
+        m_Locs.push_back(Data);
+        Index  = (uint8_t)(m_Locs.size() - 1);
+        Result = true;
+    }
+    else if ((Store == storeChange) && (Index != 255))
+    {
+        Result = true;
+    }
+
+    if (Result == true)
+    {
+        HostMicros += HostStoreTime;
+        if (FunctionsPtr != NULL)
+        {
+            memcpy(m_Locs[Index].FunctionAssignment, FunctionsPtr, sizeof(Data.FunctionAssignment));
+        }
+        if (NamePtr != NULL)
+        {
+            memset(m_Locs[Index].Name, 0, sizeof(Data.Name));
+            strncpy(m_Locs[Index].Name, NamePtr, sizeof(Data.Name) - 1);
+        }
+        m_StorageWrites++;
+    }
+
+    return (Result);
+}
+
+/***********************************************************************************************************************
+ */
+bool LocLib::RemoveLoc(uint16_t Address)
+{
+    uint8_t Index = CheckLoc(Address);
+    bool Result   = false;
+
+    if (Index != 255)
+    {
+        m_Locs.erase(m_Locs.begin() + Index);
+        m_StorageWrites++;
+        Result = true;
+    }
+
+    return (Result);
+}
+
+/***********************************************************************************************************************
+ */
+uint8_t LocLib::CheckLoc(uint16_t Address)
+{
+    uint8_t Result = 255;
+    size_t Index;
+
+    for (Index = 0; (Index < m_Locs.size()) && (Result == 255); Index++)
+    {
+        if (m_Locs[Index].Addres == Address)
+        {
+            Result = (uint8_t)(Index);
+        }
+    }
+
+    return (Result);
+}
+
+/***********************************************************************************************************************
+ */
+void LocLib::LocBubbleSort(void)
+{
+    std::sort(m_Locs.begin(), m_Locs.end(),
+        [](const LocLibData& First, const LocLibData& Second) { return (First.Addres < Second.Addres); });
+}
+
+/***********************************************************************************************************************
+ */
+void LocLib::InitialLocStore(void)
+{
+    m_Locs.clear();
+    m_StorageWrites++;
+}
+
+/***********************************************************************************************************************
+ */
+void LocLib::FunctionAssignedGetStored(uint16_t Address, uint8_t* FunctionsPtr)
+{
+    uint8_t Index = CheckLoc(Address);
+
+    if (Index != 255)
+    {
+        memcpy(FunctionsPtr, m_Locs[Index].FunctionAssignment, sizeof(m_Locs[Index].FunctionAssignment));
+        m_StorageReads++;
+    }
+}
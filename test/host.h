@@ -0,0 +1,77 @@
+/***********************************************************************************************************************
+   @file  host.h
+   @brief Host model of the hardware used by the cli tests: serial port, clock, EEPROM and loc lib.
+ **********************************************************************************************************************/
+
+#ifndef HOST_H
+#define HOST_H
+
+/***********************************************************************************************************************
+   I N C L U D E S
+ **********************************************************************************************************************/
+#include "WmcCli.h"
+#include <string>
+
+/***********************************************************************************************************************
+ * F U N C T I O N S
+ **********************************************************************************************************************/
+
+/**
+ * Add data to the receive buffer of the serial port.
+ */
+void HostInput(const std::string& Data);
+
+/**
+ * Get and clear the data sent by the cli.
+ */
+std::string HostOutput(void);
+
+/**
+ * Run the cli until all received data is processed, the clock advances 1 ms per update.
+ */
+void HostRun(WmcCli& Cli);
+
+/**
+ * Use the real clock of the host for millis() and micros() instead of the clock advanced by HostRun().
+ */
+void HostClockReal(bool Real);
+
+/**
+ * Get the number of EEPROM commits.
+ */
+uint32_t HostCommitsGet(void);
+
+/**
+ * Model the serial line: received bytes arrive one by one at the baud rate in a receive buffer of FifoSize bytes,
+ * bytes arriving at a full buffer are dropped. The host stops sending StopLatency bytes after the XOFF of the cli
+ * and continues after XON. Baud 0 switches the model off, data is then available at once.
+ */
+void HostUartModel(uint32_t Baud, uint16_t FifoSize, uint16_t StopLatency);
+
+/**
+ * Send data at the given time (us) of the host clock, requires the serial line model. Data must be scheduled in
+ * time order.
+ */
+void HostInputAt(unsigned long Time, const std::string& Data);
+
+/**
+ * Add "<begin baud>" to the data sent by the cli at each baud rate change, so the data sent at each rate is known.
+ */
+void HostBaudMarkSet(bool Mark);
+
+/**
+ * Get the number of received bytes dropped by the serial line model.
+ */
+uint32_t HostDroppedGet(void);
+
+/**
+ * Duration in us of a loc store of the loc lib and of an EEPROM commit, the clock advances by it.
+ */
+void HostStorageDelay(uint32_t StoreTime, uint32_t CommitTime);
+
+/**
+ * Let each loc store of the loc lib for Address fail like a write error of the storage, 0 ends the failures.
+ */
+void HostStoreFail(uint16_t Address);
+
+#endif
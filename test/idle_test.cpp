@@ -0,0 +1,181 @@
+/***********************************************************************************************************************
+   @file  idle_test.cpp
+   @brief Active cycles of the cli for a trace of 10 minutes with long idle times, single commands, a pasted block,
+          a roster import and a network change at 115200 baud. A main loop which polls Update() every ms is compared
+          with a main loop which calls IdleWait() after each Update(), both must process the trace the same way
+          without lost data.
+ **********************************************************************************************************************/
+
+/***********************************************************************************************************************
+   I N C L U D E S
+ **********************************************************************************************************************/
+#include "host.h"
+#include <algorithm>
+#include <string>
+#include <utility>
+#include <vector>
+
+/***********************************************************************************************************************
+   D A T A   D E C L A R A T I O N S (exported, local)
+ **********************************************************************************************************************/
+static const unsigned long TraceTime = 600000; /* ms */
+static const uint32_t IdleMaxTime    = 1000;   /* ms, longest wait the application allows. */
+
+struct loopResult
+{
+    uint32_t Updates;
+    unsigned long Sleep; /* us spent in IdleWait(). */
+    uint32_t Dropped;
+    std::string Roster;
+};
+
+/***********************************************************************************************************************
+   F U N C T I O N S
+ **********************************************************************************************************************/
+
+/***********************************************************************************************************************
+ * Schedule the trace, times in ms from Start (us).
+ */
+static void TraceSchedule(unsigned long Start)
+{
+    std::vector<std::pair<unsigned long, std::string> > Trace;
+    std::string Data;
+    char Line[100];
+    uint16_t Index;
+
+    Trace.push_back(std::make_pair(0UL, std::string("clear\r\n")));
+    Trace.push_back(std::make_pair(1000UL, std::string("list\r\n")));
+
+    /* A single command every 30 s. */
+    for (Index = 1; Index < 20; Index++)
+    {
+        snprintf(Line, sizeof(Line), "add %u\r\n", (unsigned)(100 + Index));
+        Trace.push_back(std::make_pair(Index * 30000UL + 500UL, std::string(Line)));
+    }
+
+    /* Pasted block of commands. */
+    Data.clear();
+    for (Index = 0; Index < 20; Index++)
+    {
+        snprintf(Line, sizeof(Line), "change 101 %u %u\r\n", (unsigned)(Index % 5), (unsigned)(Index + 5));
+        Data += Line;
+    }
+    Trace.push_back(std::make_pair(120000UL, Data));
+
+    /* Roster import. */
+    Data = "import\r\n<roster-config>\r\n";
+    for (Index = 0; Index < 10; Index++)
+    {
+        snprintf(Line, sizeof(Line), "<locomotive id=\"V 100 %03u\" dccAddress=\"%u\"/>\r\n", (unsigned)(Index),
+            (unsigned)(200 + Index));
+        Data += Line;
+    }
+    Data += "</roster-config>\r\n";
+    Trace.push_back(std::make_pair(300000UL, Data));
+
+    /* Network change, the reconnect is polled. */
+    Trace.push_back(std::make_pair(400000UL, std::string("ssid Train Net\r\n")));
+    Trace.push_back(std::make_pair(TraceTime - 1000UL, std::string("list\r\n")));
+
+    std::stable_sort(Trace.begin(), Trace.end(),
+        [](const std::pair<unsigned long, std::string>& First, const std::pair<unsigned long, std::string>& Second) {
+            return (First.first < Second.first);
+        });
+
+    for (Index = 0; Index < Trace.size(); Index++)
+    {
+        HostInputAt(Start + (Trace[Index].first * 1000UL), Trace[Index].second);
+    }
+}
+
+/***********************************************************************************************************************
+ * Run the trace with a polling main loop or a main loop with IdleWait().
+ */
+static loopResult TraceRun(bool Idle)
+{
+    WmcCli Cli;
+    LocLib Lib;
+    LocStorage Storage;
+    loopResult Result = { 0, 0, 0, "" };
+    unsigned long Start;
+    unsigned long Before;
+    std::string Output;
+    size_t Position;
+
+    Cli.Init(Lib, Storage);
+    HostOutput();
+
+    HostUartModel(115200, 512, 16);
+    Start = micros();
+    TraceSchedule(Start);
+
+    while ((micros() - Start) < (TraceTime * 1000UL))
+    {
+        Cli.Update();
+        Result.Updates++;
+
+        if (Idle == true)
+        {
+            Before = micros();
+            Cli.IdleWait(IdleMaxTime);
+            Result.Sleep += micros() - Before;
+        }
+        else
+        {
+            delay(1);
+        }
+    }
+
+    Result.Dropped = HostDroppedGet();
+    HostUartModel(0, 0, 0);
+
+    /* The roster of the last list, the generation depends on the roster before the trace. */
+    Output   = HostOutput();
+    Position = Output.rfind("Address B0");
+    if (Position != std::string::npos)
+    {
+        Result.Roster = Output.substr(Position);
+        Result.Roster = Result.Roster.substr(0, Result.Roster.find(", generation"));
+    }
+
+    return (Result);
+}
+
+/***********************************************************************************************************************
+ */
+int main(void)
+{
+    loopResult Polling;
+    loopResult Idle;
+    uint32_t Failures = 0;
+
+    Polling = TraceRun(false);
+    Idle    = TraceRun(true);
+
+    printf("Main loop  updates  updates/s  in IdleWait  dropped\n");
+    printf("polling    %7u  %9.1f  %10.1f%%  %7u\n", Polling.Updates, Polling.Updates / (TraceTime / 1000.0), 0.0,
+        Polling.Dropped);
+    printf("idle wait  %7u  %9.1f  %10.1f%%  %7u\n", Idle.Updates, Idle.Updates / (TraceTime / 1000.0),
+        Idle.Sleep / (TraceTime * 10.0), Idle.Dropped);
+    printf("Active cycles reduced %.1fx\n", (Idle.Updates > 0) ? (double)(Polling.Updates) / Idle.Updates : 0.0);
+
+    if ((Polling.Dropped != 0) || (Idle.Dropped != 0))
+    {
+        printf("received data lost\n");
+        Failures++;
+    }
+
+    if ((Polling.Roster.empty() == true) || (Polling.Roster != Idle.Roster))
+    {
+        printf("roster of polling and idle wait differs\n");
+        Failures++;
+    }
+
+    if ((Idle.Updates * 10) > Polling.Updates)
+    {
+        printf("idle wait saves less than 90%% of the updates\n");
+        Failures++;
+    }
+
+    return (Failures == 0) ? 0 : 1;
+}
@@ -0,0 +1,197 @@
+/***********************************************************************************************************************
+   @file  integrity_test.cpp
+   @brief Checksums of the data regions over a reset. Commands of the cli seal the changed regions before the reset,
+          also when the reset follows the command at once, so the next start finds no corrupt region. Writes of the
+          application without IntegritySeal() and damaged EEPROM data are reported as corrupt, invalid values are
+          restored at the start and verify repair accepts the remaining data. A reset loses all EEPROM data which was
+          not committed, the undo journal must survive it.
+ **********************************************************************************************************************/
+
+/***********************************************************************************************************************
+   I N C L U D E S
+ **********************************************************************************************************************/
+#include "EEPROM.h"
+#include "eep_cfg.h"
+#include "host.h"
+#include <string>
+
+/***********************************************************************************************************************
+   D A T A   D E C L A R A T I O N S (exported, local)
+ **********************************************************************************************************************/
+static const char* const Commands[] = {
+    "add 3",
+    "add 10",
+    "add 11",
+    "add 12",
+    "change 3 1 5",
+    "change 10-12 2 7",
+    "name 3 BR 218 Long Name",
+    "name 10-11 prefix NS ",
+    "del 11",
+    "sync loc 20 0 1 2 3 4 Koef",
+    "ac 1",
+    "emergency 1",
+    "ssid Train Net",
+    "ip 192.168.2.20",
+    "static 1",
+    "undo",
+};
+
+static LocLib Lib;
+static LocStorage Storage;
+static uint32_t Failures = 0;
+
+/***********************************************************************************************************************
+   F U N C T I O N S
+ **********************************************************************************************************************/
+
+/***********************************************************************************************************************
+ * Start a new cli on the stored data and run the commands, return the output of the start and the commands.
+ */
+static std::string Reset(const char* CommandsPtr)
+{
+    WmcCli Cli;
+
+    EEPROM.discard();
+    Cli.Init(Lib, Storage);
+    HostInput(CommandsPtr);
+    HostRun(Cli);
+
+    return (HostOutput());
+}
+
+/***********************************************************************************************************************
+ */
+static void Check(const char* TestName, const std::string& Output, const char* Expected)
+{
+    if (Output.find(Expected) == std::string::npos)
+    {
+        printf("%-40s failed, \"%s\" missing\n", TestName, Expected);
+        Failures++;
+    }
+    else
+    {
+        printf("%-40s ok\n", TestName);
+    }
+}
+
+/***********************************************************************************************************************
+ */
+static void CheckNot(const char* TestName, const std::string& Output, const char* Unexpected)
+{
+    if (Output.find(Unexpected) != std::string::npos)
+    {
+        printf("%-40s failed, \"%s\" found\n", TestName, Unexpected);
+        Failures++;
+    }
+    else
+    {
+        printf("%-40s ok\n", TestName);
+    }
+}
+
+/***********************************************************************************************************************
+ */
+int main(void)
+{
+    std::string Output;
+    uint8_t Functions[5] = { 0, 1, 2, 3, 4 };
+    uint8_t Index;
+
+    /* First start seals all regions. */
+    Output = Reset("verify\r\n");
+    CheckNot("first start", Output, "corrupt");
+
+    /* Each command is followed by a reset before the change event is sent. */
+    for (Index = 0; Index < (sizeof(Commands) / sizeof(Commands[0])); Index++)
+    {
+        WmcCli Cli;
+
+        Cli.Init(Lib, Storage);
+        HostInput(std::string(Commands[Index]) + "\r\n");
+        Cli.Update();
+        HostOutput();
+
+        Output = Reset("verify\r\n");
+        CheckNot(Commands[Index], Output, "corrupt");
+    }
+
+    /* Undo right before a reset, the reverted add must be gone from the journal. */
+    for (Index = 0; Index < 2; Index++)
+    {
+        WmcCli Cli;
+
+        EEPROM.discard();
+        Cli.Init(Lib, Storage);
+        HostInput((Index == 0) ? "add 60\r\n" : "undo\r\n");
+        Cli.Update();
+        HostOutput();
+    }
+    Output = Reset("history\r\n");
+    CheckNot("undo journal after reset", Output, ": add 60");
+
+    /* A loc added by the application without a seal. */
+    Lib.StoreLoc(50, Functions, NULL, LocLib::storeAdd);
+    Lib.LocBubbleSort();
+    Output = Reset("verify repair\r\n");
+    Check("application write without seal", Output, "locs corrupt, use verify repair.");
+    Check("repair of unsealed write", Output, "locs repaired.");
+    Output = Reset("verify\r\n");
+    CheckNot("start after repair", Output, "corrupt");
+
+    /* A loc added by the application with a seal. */
+    {
+        WmcCli Cli;
+
+        Cli.Init(Lib, Storage);
+        Lib.StoreLoc(51, Functions, NULL, LocLib::storeAdd);
+        Lib.LocBubbleSort();
+        Cli.LocIndexInvalidate();
+        Cli.IntegritySeal(WmcCli::cliChangeRoster);
+        HostOutput();
+    }
+    Output = Reset("verify\r\n");
+    CheckNot("application write with seal", Output, "corrupt");
+
+    /* An invalid function is restored at the start without undo record, output or change event. */
+    Functions[2] = 40;
+    Lib.StoreLoc(52, Functions, NULL, LocLib::storeAdd);
+    Lib.LocBubbleSort();
+    {
+        WmcCli Cli;
+
+        Cli.Init(Lib, Storage);
+        HostInput("history\r\nlist\r\n");
+        HostRun(Cli);
+        Output = HostOutput();
+        Check("invalid function restored", Output, "  52     0  1  2  3  4");
+        CheckNot("restore without output", Output, "Loc function updated.");
+        CheckNot("restore not journaled", Output, "change 52");
+        if (Cli.ChangeGet() != WmcCli::cliChangeNone)
+        {
+            printf("%-40s failed, event sent\n", "restore without event");
+            Failures++;
+        }
+    }
+    Reset("verify repair\r\n");
+
+    /* Damaged gateway address, the value itself is valid. */
+    EEPROM.write(EepCfg::EepIpGateway, EEPROM.read(EepCfg::EepIpGateway) ^ 0x01);
+    EEPROM.commit();
+    Output = Reset("verify repair\r\n");
+    Check("damaged network data", Output, "network corrupt, use verify repair.");
+    Check("repair of damaged network data", Output, "network repaired.");
+
+    /* Invalid static option, restored at the start but still reported. */
+    EEPROM.write(EepCfg::StaticIpAddress, 7);
+    EEPROM.commit();
+    Output = Reset("get static\r\n");
+    Check("invalid static option", Output, "network corrupt, use verify repair.");
+    Check("invalid static option restored", Output, "\rstatic 0\r\n");
+    Output = Reset("verify repair\r\n");
+    Check("corrupt until repair", Output, "network corrupt, use verify repair.");
+    Output = Reset("verify\r\n");
+    CheckNot("start after repair", Output, "corrupt");
+
+    return (Failures == 0) ? 0 : 1;
+}
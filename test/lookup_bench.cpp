@@ -0,0 +1,138 @@
+/***********************************************************************************************************************
+   @file  lookup_bench.cpp
+   @brief Loc lookup of the loc lib (linear CheckLoc) against the address index of the cli for several roster sizes,
+          measured with the bench command on the real clock of the host. The listing and the storage reads of the
+          list and change commands are reported too, change reads the functions of a loc from the storage. The RAM
+          of the index is reported with the size of the cli object of this build.
+ **********************************************************************************************************************/
+
+/***********************************************************************************************************************
+   I N C L U D E S
+ **********************************************************************************************************************/
+#include "host.h"
+#include <chrono>
+#include <string>
+
+/***********************************************************************************************************************
+   D A T A   D E C L A R A T I O N S (exported, local)
+ **********************************************************************************************************************/
+static const uint16_t RosterSizes[] = { 8, 32, 64, 128, 253 };
+
+/***********************************************************************************************************************
+   F U N C T I O N S
+ **********************************************************************************************************************/
+
+/***********************************************************************************************************************
+ * Get the median in ns of a bench row, 0 if the row is missing.
+ */
+static unsigned long BenchMedianGet(const std::string& Output, const char* TestName)
+{
+    unsigned long Ops    = 0;
+    unsigned long Median = 0;
+    size_t Position      = Output.find(std::string("\r\n") + TestName + " ");
+
+    if (Position != std::string::npos)
+    {
+        sscanf(Output.c_str() + Position + 2 + 15, "%lu %lu", &Ops, &Median);
+    }
+
+    return (Median);
+}
+
+/***********************************************************************************************************************
+ */
+static long HostElapsedUs(std::chrono::steady_clock::time_point Start)
+{
+    return ((long)(std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - Start)
+                       .count()));
+}
+
+/***********************************************************************************************************************
+ */
+int main(void)
+{
+    WmcCli Cli;
+    LocLib Lib;
+    LocStorage Storage;
+    std::string Output;
+    std::chrono::steady_clock::time_point Start;
+    char Line[40];
+    unsigned long CheckLoc;
+    unsigned long LocIndex;
+    long ListUs;
+    long IdleUs;
+    uint32_t Reads;
+    uint32_t Failures     = 0;
+    uint16_t NumberOfLocs = 0;
+    uint8_t Size;
+
+    Cli.Init(Lib, Storage);
+
+    printf("Locs  checkloc ns  loc index ns  speedup  list us  list reads  change reads\n");
+    for (Size = 0; Size < (sizeof(RosterSizes) / sizeof(RosterSizes[0])); Size++)
+    {
+        /* Grow the roster, the addresses are spread so the index sees collisions. */
+        HostClockReal(false);
+        while (NumberOfLocs < RosterSizes[Size])
+        {
+            NumberOfLocs++;
+            snprintf(Line, sizeof(Line), "add %u\r\n", (unsigned)((NumberOfLocs * 37U) % 9999U) + 1);
+            HostInput(Line);
+        }
+        HostRun(Cli);
+        HostOutput();
+
+        HostClockReal(true);
+        HostInput("bench\r\n");
+        HostRun(Cli);
+        Output   = HostOutput();
+        CheckLoc = BenchMedianGet(Output, "checkloc");
+        LocIndex = BenchMedianGet(Output, "loc index");
+
+        /* The idle updates of HostRun are measured first and subtracted from the list time. */
+        Start = std::chrono::steady_clock::now();
+        HostRun(Cli);
+        IdleUs = HostElapsedUs(Start);
+
+        Reads = Lib.m_StorageReads;
+        Start = std::chrono::steady_clock::now();
+        HostInput("list\r\n");
+        HostRun(Cli);
+        ListUs = HostElapsedUs(Start) - IdleUs;
+        Output = HostOutput();
+        Reads  = Lib.m_StorageReads - Reads;
+
+        if ((Output.find("Address B0") == std::string::npos) || (Reads != 0))
+        {
+            printf("list of %u locs failed\n", NumberOfLocs);
+            Failures++;
+        }
+
+        printf("%4u  %11lu  %12lu  %6.1fx  %7ld  %10u", NumberOfLocs, CheckLoc, LocIndex,
+            (LocIndex > 0) ? (double)(CheckLoc) / LocIndex : 0.0, ListUs, Reads);
+
+        Reads = Lib.m_StorageReads;
+        snprintf(Line, sizeof(Line), "change 1 0 %u\r\n", (unsigned)(Size + 1));
+        HostClockReal(false);
+        HostInput("add 1\r\n");
+        HostInput(Line);
+        HostInput("del 1\r\n");
+        HostRun(Cli);
+        Output = HostOutput();
+        Reads  = Lib.m_StorageReads - Reads;
+        printf("  %12u\n", Reads);
+
+        /* change reads the functions of the loc from the storage once. */
+        if ((Output.find("Loc function updated.") == std::string::npos) || (Reads != 1))
+        {
+            printf("change with %u locs failed\n", NumberOfLocs);
+            Failures++;
+        }
+    }
+
+    printf("Loc index RAM : %u bytes (%u entries), cli object %u bytes\n",
+        (unsigned)(WMC_CLI_LOC_INDEX_SIZE * sizeof(uint16_t)), (unsigned)(WMC_CLI_LOC_INDEX_SIZE),
+        (unsigned)(sizeof(WmcCli)));
+
+    return (Failures == 0) ? 0 : 1;
+}
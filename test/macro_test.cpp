@@ -0,0 +1,72 @@
+/***********************************************************************************************************************
+   @file  macro_test.cpp
+   @brief Macro recording. A second macro record while a recording is active is rejected and the buffered recording
+          is stored by macro end, macro abort stops a recording without storing it.
+ **********************************************************************************************************************/
+
+/***********************************************************************************************************************
+   I N C L U D E S
+ **********************************************************************************************************************/
+#include "host.h"
+#include <string>
+
+/***********************************************************************************************************************
+   D A T A   D E C L A R A T I O N S (exported, local)
+ **********************************************************************************************************************/
+static uint32_t Failures = 0;
+
+/***********************************************************************************************************************
+   F U N C T I O N S
+ **********************************************************************************************************************/
+
+/***********************************************************************************************************************
+ */
+static void Check(const char* TestName, const std::string& Output, const char* Expected, bool Present)
+{
+    if ((Output.find(Expected) != std::string::npos) != Present)
+    {
+        printf("%-36s failed, \"%s\" %s\n", TestName, Expected, (Present == true) ? "missing" : "found");
+        Failures++;
+    }
+    else
+    {
+        printf("%-36s ok\n", TestName);
+    }
+}
+
+/***********************************************************************************************************************
+ */
+int main(void)
+{
+    WmcCli Cli;
+    LocLib Lib;
+    LocStorage Storage;
+    std::string Output;
+
+    Cli.Init(Lib, Storage);
+    HostInput("macro del first\r\nmacro del second\r\nmacro del third\r\n");
+    HostRun(Cli);
+    HostOutput();
+
+    /* Record while recording, the first recording must remain. */
+    HostInput("macro record first\r\nadd $1\r\nmacro record second\r\nchange $1 0 3\r\nmacro end\r\nmacro list\r\n");
+    HostRun(Cli);
+    Output = HostOutput();
+    Check("second record rejected", Output, "Macro recording active, stop with macro end or macro abort first.", true);
+    Check("first macro stored", Output, "first : ", true);
+    Check("second macro not stored", Output, "second : ", false);
+
+    /* Abort, nothing is stored and the next record starts. */
+    HostInput("macro record third\r\nadd $1\r\nmacro abort\r\nmacro end\r\nmacro list\r\n");
+    HostRun(Cli);
+    Output = HostOutput();
+    Check("abort", Output, "Macro recording aborted, nothing stored.", true);
+    Check("end after abort", Output, "No macro recording active.", true);
+    Check("aborted macro not stored", Output, "third : ", false);
+
+    HostInput("macro record third\r\nmacro end\r\nmacro list\r\n");
+    HostRun(Cli);
+    Check("record after abort", HostOutput(), "third : ", true);
+
+    return (Failures == 0) ? 0 : 1;
+}
@@ -0,0 +1,118 @@
+/***********************************************************************************************************************
+   @file  name_bench.cpp
+   @brief Storage bytes per loc of the name pool for a roster with names as found in JMRI rosters. The names are
+          stored with the name command and read back with dump, which must return every name unchanged. The pool
+          is added to the 11 byte name field of the loc lib, so it costs storage for each long name compared with
+          the loc lib alone and buys names up to WMC_CLI_NAME_LENGTH characters.
+ **********************************************************************************************************************/
+
+/***********************************************************************************************************************
+   I N C L U D E S
+ **********************************************************************************************************************/
+#include "EEPROM.h"
+#include "host.h"
+#include <string>
+#include <vector>
+
+/***********************************************************************************************************************
+   D A T A   D E C L A R A T I O N S (exported, local)
+ **********************************************************************************************************************/
+static const char* const NamePatterns[] = {
+    "BR 218 %03u",
+    "BR 218 %03u-%u",
+    "BR 103 %03u TEE",
+    "BR 01 %03u Museum",
+    "BR 50 %04u Kab",
+    "NS 1700 %u",
+    "NS 1600 Rotterdam %u",
+    "Class 66 %03u",
+    "Class 37 %03u (Ep.V)",
+    "UP 4014 Big Boy %u",
+    "SP 4449 Daylight %u",
+    "V 100 %03u",
+    "E 44 %03u",
+    "Koef %u",
+};
+
+/***********************************************************************************************************************
+   F U N C T I O N S
+ **********************************************************************************************************************/
+
+/***********************************************************************************************************************
+ */
+int main(void)
+{
+    WmcCli Cli;
+    LocLib Lib;
+    LocStorage Storage;
+    std::vector<std::string> Names;
+    std::string Output;
+    std::string Expected;
+    char Line[80];
+    char Name[WMC_CLI_NAME_LENGTH + 1];
+    uint32_t Random             = 12345;
+    uint32_t NameBytes          = 0;
+    uint32_t LongNames          = 0;
+    uint32_t Failures           = 0;
+    uint32_t PoolBytes          = 0;
+    uint32_t Reads              = 0;
+    const uint16_t NumberOfLocs = 120;
+    size_t Position;
+    uint16_t Index;
+
+    Cli.Init(Lib, Storage);
+
+    for (Index = 0; Index < NumberOfLocs; Index++)
+    {
+        Random = (Random * 1103515245U) + 12345U;
+        snprintf(Name, sizeof(Name), NamePatterns[(Random >> 16) % (sizeof(NamePatterns) / sizeof(NamePatterns[0]))],
+            Index + 1, (Random >> 8) % 9);
+        Names.push_back(Name);
+        NameBytes += strlen(Name) + 1;
+        LongNames += (strlen(Name) >= sizeof(LocLibData::Name)) ? 1 : 0;
+
+        snprintf(Line, sizeof(Line), "add %u\r\nname %u %s\r\n", Index + 1, Index + 1, Name);
+        HostInput(Line);
+    }
+
+    Reads = EEPROM.readsGet();
+    HostRun(Cli);
+    Reads = EEPROM.readsGet() - Reads;
+    HostOutput();
+
+    HostInput("settings\r\ndump\r\n");
+    HostRun(Cli);
+    Output = HostOutput();
+
+    Position = Output.find("Name pool       : ");
+    if (Position != std::string::npos)
+    {
+        PoolBytes = (uint32_t)(atoi(Output.c_str() + Position + 18));
+    }
+
+    for (Index = 0; Index < NumberOfLocs; Index++)
+    {
+        Expected = "name " + std::to_string(Index + 1) + " " + Names[Index] + "\r\n";
+        if (Output.find(Expected) == std::string::npos)
+        {
+            printf("Name of loc %u not restored: %s\n", Index + 1, Names[Index].c_str());
+            Failures++;
+        }
+    }
+
+    printf("Locs                          : %u (%u names longer than %u characters)\n", NumberOfLocs, LongNames,
+        (unsigned)(sizeof(LocLibData::Name) - 1));
+    printf("Name text incl. terminator    : %.1f bytes per loc\n", (double)(NameBytes) / NumberOfLocs);
+    printf("Fixed name field (%2u chars)   : %u bytes per loc\n", WMC_CLI_NAME_LENGTH, WMC_CLI_NAME_LENGTH + 1);
+    printf("Loc lib name + name pool      : %.1f bytes per loc (%u + %.1f), pool %u bytes\n",
+        (double)(sizeof(LocLibData::Name)) + ((double)(PoolBytes) / NumberOfLocs), (unsigned)(sizeof(LocLibData::Name)),
+        (double)(PoolBytes) / NumberOfLocs, PoolBytes);
+    printf("Name pool per long name       : %.1f bytes\n", (LongNames > 0) ? (double)(PoolBytes) / LongNames : 0.0);
+    printf("Loc lib name only (baseline)  : %u bytes per loc, names cut to %u characters\n",
+        (unsigned)(sizeof(LocLibData::Name)), (unsigned)(sizeof(LocLibData::Name) - 1));
+    printf("Cost of the name pool         : +%.1f bytes per loc (+%.0f%%) for the full names\n",
+        (double)(PoolBytes) / NumberOfLocs, ((double)(PoolBytes) * 100.0) / (NumberOfLocs * sizeof(LocLibData::Name)));
+    printf("EEPROM reads per add and name : %.0f\n", (double)(Reads) / NumberOfLocs);
+
+    return ((Failures == 0) && (PoolBytes > 0)) ? 0 : 1;
+}
@@ -0,0 +1,151 @@
+/***********************************************************************************************************************
+   @file  settings_test.cpp
+   @brief The legacy per setting commands of the ESP8266 (ssid, password, z21, static, ip, gateway and subnet) are
+          executed through the settings table, each command must store the same value as set and get must show it.
+          The ac and emergency options written with eep write must reach the loc storage like a set.
+ **********************************************************************************************************************/
+
+/***********************************************************************************************************************
+   I N C L U D E S
+ **********************************************************************************************************************/
+#include "eep_cfg.h"
+#include "host.h"
+#include <string>
+
+/***********************************************************************************************************************
+   D A T A   D E C L A R A T I O N S (exported, local)
+ **********************************************************************************************************************/
+struct settingCase
+{
+    const char* Command; /* Legacy command as entered. */
+    const char* Key;     /* Key of the setting for get. */
+    const char* Shown;   /* Setting as shown by get, NULL if the command must be rejected. */
+};
+
+/* Option written with eep write, the key and the value shown by get afterwards, NULL if rejected. */
+struct eepCase
+{
+    int EepAddress;
+    const char* Data;
+    const char* Key;
+    const char* Shown;
+};
+
+static const eepCase EepCases[] = {
+    { EepCfg::AcTypeControlAddress, "01", "ac", "ac 1" },
+    { EepCfg::AcTypeControlAddress, "00", "ac", "ac 0" },
+    { EepCfg::EmergencyStopEnabledAddress, "01", "emergency", "emergency 1" },
+    { EepCfg::AcTypeControlAddress, "07", "ac", NULL },
+};
+
+static const settingCase Cases[] = {
+    { "static 1", "static", "static 1" },
+    { "static 0", "static", "static 0" },
+    { "static  1", "static", "static 1" },
+    { "static 2", "static", NULL },
+    { "static 256", "static", NULL },
+    { "ip 192.168.2.20", "ip", "ip 192.168.2.20" },
+    { "gateway 192.168.2.1", "gateway", "gateway 192.168.2.1" },
+    { "subnet 255.255.255.0", "subnet", "subnet 255.255.255.0" },
+    { "z21 192.168.2.10", "z21", "z21 192.168.2.10" },
+    { "z21 192.168", "z21", NULL },
+    { "ssid Train Net", "ssid", "ssid Train Net" },
+    { "password secret pw", "password", "password secret pw" },
+};
+
+/***********************************************************************************************************************
+   F U N C T I O N S
+ **********************************************************************************************************************/
+
+/***********************************************************************************************************************
+ */
+int main(void)
+{
+    WmcCli Cli;
+    LocLib Lib;
+    LocStorage Storage;
+    std::string Output;
+    std::string Before;
+    std::string Expected;
+    char Command[40];
+    uint32_t Failures = 0;
+    uint8_t Index;
+
+    Cli.Init(Lib, Storage);
+    HostRun(Cli);
+    HostOutput();
+
+    for (Index = 0; Index < (sizeof(Cases) / sizeof(Cases[0])); Index++)
+    {
+        HostInput(std::string("get ") + Cases[Index].Key + "\r\n");
+        HostRun(Cli);
+        Before = HostOutput();
+
+        HostInput(std::string(Cases[Index].Command) + "\r\n");
+        HostInput(std::string("get ") + Cases[Index].Key + "\r\n");
+        HostRun(Cli);
+        Output = HostOutput();
+
+        if (Cases[Index].Shown != NULL)
+        {
+            /* Stored and shown by get. */
+            Expected = std::string("Stored : ") + Cases[Index].Shown + "\r\n";
+            if ((Output.find(Expected) == std::string::npos)
+                || (Output.find(std::string("\r") + Cases[Index].Shown + "\r\n", Output.find(Expected) + 1)
+                    == std::string::npos))
+            {
+                printf("%-22s failed\n", Cases[Index].Command);
+                Failures++;
+            }
+            else
+            {
+                printf("%-22s ok\n", Cases[Index].Command);
+            }
+        }
+        else
+        {
+            /* Rejected and the old value remains. */
+            Expected = std::string(Cases[Index].Key) + " entry invalid!\r\n";
+            if ((Output.find(Expected) == std::string::npos)
+                || (Output.find(Before.substr(Before.find('\r') + 1)) == std::string::npos))
+            {
+                printf("%-22s not rejected\n", Cases[Index].Command);
+                Failures++;
+            }
+            else
+            {
+                printf("%-22s rejected\n", Cases[Index].Command);
+            }
+        }
+    }
+
+    for (Index = 0; Index < (sizeof(EepCases) / sizeof(EepCases[0])); Index++)
+    {
+        snprintf(Command, sizeof(Command), "eep write %d %s", EepCases[Index].EepAddress, EepCases[Index].Data);
+        HostInput(std::string(Command) + "\r\n");
+        HostInput(std::string("get ") + EepCases[Index].Key + "\r\n");
+        HostRun(Cli);
+        Output = HostOutput();
+
+        if (EepCases[Index].Shown != NULL)
+        {
+            Expected = std::string("\r") + EepCases[Index].Shown + "\r\n";
+        }
+        else
+        {
+            Expected = "Option value invalid, must be 00 or 01.\r\n";
+        }
+
+        if (Output.find(Expected) == std::string::npos)
+        {
+            printf("%-22s failed\n", Command);
+            Failures++;
+        }
+        else
+        {
+            printf("%-22s %s\n", Command, (EepCases[Index].Shown != NULL) ? "ok" : "rejected");
+        }
+    }
+
+    return (Failures == 0) ? 0 : 1;
+}
@@ -0,0 +1,113 @@
+/***********************************************************************************************************************
+   @file  store_test.cpp
+   @brief Loc stores which fail in the loc lib. The range commands count the failed locs in their totals, a failed
+          change, name or sync loc reports the failure and changes neither the roster generation nor the checksum of
+          the locs.
+ **********************************************************************************************************************/
+
+/***********************************************************************************************************************
+   I N C L U D E S
+ **********************************************************************************************************************/
+#include "host.h"
+#include <string>
+
+/***********************************************************************************************************************
+   D A T A   D E C L A R A T I O N S (exported, local)
+ **********************************************************************************************************************/
+static WmcCli Cli;
+static uint32_t Failures = 0;
+
+/***********************************************************************************************************************
+   F U N C T I O N S
+ **********************************************************************************************************************/
+
+/***********************************************************************************************************************
+ * Run a command, the command must show Expected and must not change the roster generation when Generation is false.
+ */
+static void Run(const char* CommandPtr, const char* Expected, bool Generation)
+{
+    std::string Output;
+    uint16_t Before = Cli.RosterGenerationGet();
+
+    HostInput(std::string(CommandPtr) + "\r\n");
+    HostRun(Cli);
+    Output = HostOutput();
+
+    if (Output.find(Expected) == std::string::npos)
+    {
+        printf("%-28s failed, \"%s\" missing\n", CommandPtr, Expected);
+        Failures++;
+    }
+    else if ((Generation == false) && (Cli.RosterGenerationGet() != Before))
+    {
+        printf("%-28s failed, roster generation changed\n", CommandPtr);
+        Failures++;
+    }
+    else
+    {
+        printf("%-28s ok\n", CommandPtr);
+    }
+}
+
+/***********************************************************************************************************************
+ * The running checksum of the locs must match a full recalculation.
+ */
+static void ChecksumCheck(const char* TestName)
+{
+    std::string Running;
+    std::string Full;
+
+    HostInput("checksum\r\n");
+    HostRun(Cli);
+    Running = HostOutput();
+    HostInput("checksum full\r\n");
+    HostRun(Cli);
+    Full = HostOutput();
+
+    Running = Running.substr(Running.rfind("checksum "));
+    Full    = Full.substr(Full.rfind("checksum "));
+    if (Running != Full)
+    {
+        printf("%-28s failed, checksum of the locs differs\n", TestName);
+        Failures++;
+    }
+    else
+    {
+        printf("%-28s ok\n", TestName);
+    }
+}
+
+/***********************************************************************************************************************
+ */
+int main(void)
+{
+    LocLib Lib;
+    LocStorage Storage;
+
+    Cli.Init(Lib, Storage);
+    HostInput("clear\r\nadd 10\r\nadd 11\r\nadd 12\r\n");
+    HostRun(Cli);
+    HostOutput();
+
+    HostStoreFail(11);
+    Run("change 10-12 0 7", "2 locs updated, 1 failed", true);
+    Run("name 10-12 prefix V ", "2 locs renamed, 1 failed", true);
+    Run("change 11 0 9", "Loc function update failed!", false);
+    Run("name 11 Koef", "Loc name update failed!", false);
+    Run("sync loc 11 1 2 3 4 5", "Sync loc failed, loc not stored!", false);
+    ChecksumCheck("checksum after failed change");
+
+    /* A failed add must not enter the loc in the index. */
+    HostStoreFail(30);
+    Run("sync loc 30 0 1 2 3 4", "Sync loc failed, loc not stored!", false);
+    Run("change 30 0 5", "Loc 30 is not present.", false);
+    ChecksumCheck("checksum after failed add");
+
+    HostStoreFail(0);
+    Run("sync loc 30 0 1 2 3 4", "loc 30 ", true);
+    Run("change 30 0 5", "Loc function updated.", true);
+    Run("del 10-30", "4 locs deleted, 0 failed", true);
+    ChecksumCheck("checksum after delete");
+
+    return (Failures == 0) ? 0 : 1;
+}
@@ -0,0 +1,79 @@
+/***********************************************************************************************************************
+   @file  Arduino.h
+   @brief Host replacement of the Arduino core for the cli tests, only the parts used by the cli.
+ **********************************************************************************************************************/
+
+#ifndef ARDUINO_H
+#define ARDUINO_H
+
+/***********************************************************************************************************************
+   I N C L U D E S
+ **********************************************************************************************************************/
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/***********************************************************************************************************************
+ * D E F I N E S
+ **********************************************************************************************************************/
+#define DEC 10
+#define HEX 16
+#define LOW 0
+#define HIGH 1
+#define INPUT 0
+#define OUTPUT 1
+#define A0 17
+
+/***********************************************************************************************************************
+ * C L A S S E S
+ **********************************************************************************************************************/
+
+/* Serial port of the host model, see host.h. */
+class HardwareSerial
+{
+public:
+    void begin(unsigned long Baud);
+    void end(void);
+    void flush(void);
+    int read(void);
+    int available(void);
+    size_t setRxBufferSize(size_t Size);
+    size_t write(uint8_t Data);
+    size_t write(const uint8_t* DataPtr, size_t Length);
+
+    size_t print(const char* StrPtr);
+    size_t print(char Character);
+    size_t print(unsigned char Value, int Base = DEC);
+    size_t print(int Value, int Base = DEC);
+    size_t print(unsigned int Value, int Base = DEC);
+    size_t print(long Value, int Base = DEC);
+    size_t print(unsigned long Value, int Base = DEC);
+    size_t println(void);
+
+    template <class T> size_t println(T Value)
+    {
+        size_t Result = print(Value);
+        return (Result + println());
+    }
+
+    template <class T> size_t println(T Value, int Base)
+    {
+        size_t Result = print(Value, Base);
+        return (Result + println());
+    }
+};
+
+extern HardwareSerial Serial;
+
+unsigned long millis(void);
+unsigned long micros(void);
+void delay(unsigned long Time);
+void yield(void);
+int analogRead(uint8_t Pin);
+void pinMode(uint8_t Pin, uint8_t Mode);
+void digitalWrite(uint8_t Pin, uint8_t Value);
+void nvic_sys_reset(void);
+
+#endif
@@ -0,0 +1,75 @@
+/***********************************************************************************************************************
+   @file  EEPROM.h
+   @brief Host replacement of the ESP8266 EEPROM class, a RAM buffer which counts the reads and the commits. The
+          committed data is kept apart, so a reset can lose the data which was not committed like on the ESP8266.
+ **********************************************************************************************************************/
+
+#ifndef EEPROM_H
+#define EEPROM_H
+
+/***********************************************************************************************************************
+   I N C L U D E S
+ **********************************************************************************************************************/
+#include <stdint.h>
+#include <string.h>
+
+/***********************************************************************************************************************
+ * D E F I N E S
+ **********************************************************************************************************************/
+#ifndef HOST_EEP_SIZE
+#define HOST_EEP_SIZE 4096
+#endif
+
+/***********************************************************************************************************************
+ * C L A S S E S
+ **********************************************************************************************************************/
+class EEPROMClass
+{
+public:
+    EEPROMClass()
+    {
+        memset(m_Data, 0xFF, sizeof(m_Data));
+        memset(m_Flash, 0xFF, sizeof(m_Flash));
+    }
+
+    uint8_t read(int Address)
+    {
+        m_Reads++;
+        return (m_Data[Address]);
+    }
+
+    void write(int Address, uint8_t Value) { m_Data[Address] = Value; }
+
+    template <class T> T& get(int Address, T& Data)
+    {
+        memcpy(&Data, &m_Data[Address], sizeof(T));
+        return (Data);
+    }
+
+    template <class T> const T& put(int Address, const T& Data)
+    {
+        memcpy(&m_Data[Address], &Data, sizeof(T));
+        return (Data);
+    }
+
+    bool commit(void);
+
+    uint16_t length(void) { return (HOST_EEP_SIZE); }
+
+    uint8_t* getDataPtr(void) { return (m_Data); }
+
+    /* Host only: drop the data written since the last commit. */
+    void discard(void) { memcpy(m_Data, m_Flash, sizeof(m_Data)); }
+
+    /* Host only: number of byte reads. */
+    uint32_t readsGet(void) { return (m_Reads); }
+
+private:
+    uint32_t m_Reads = 0;
+    uint8_t m_Data[HOST_EEP_SIZE];
+    uint8_t m_Flash[HOST_EEP_SIZE];
+};
+
+extern EEPROMClass EEPROM;
+
+#endif
@@ -0,0 +1,24 @@
+/***********************************************************************************************************************
+   @file  ESP8266WiFi.h
+   @brief Host replacement of the ESP8266 WiFi class, always connected.
+ **********************************************************************************************************************/
+
+#ifndef ESP8266WIFI_H
+#define ESP8266WIFI_H
+
+enum wl_status_t
+{
+    WL_IDLE_STATUS = 0,
+    WL_CONNECTED,
+    WL_DISCONNECTED
+};
+
+class ESP8266WiFiClass
+{
+public:
+    wl_status_t status(void) { return (WL_CONNECTED); }
+};
+
+extern ESP8266WiFiClass WiFi;
+
+#endif
@@ -0,0 +1,68 @@
+/***********************************************************************************************************************
+   @file  Loclib.h
+   @brief Host replacement of the loc lib and the loc storage. The loc table is kept sorted in RAM like the loc lib,
+          the number of storage accesses is counted.
+ **********************************************************************************************************************/
+
+#ifndef LOCLIB_H
+#define LOCLIB_H
+
+/***********************************************************************************************************************
+   I N C L U D E S
+ **********************************************************************************************************************/
+#include "LoclibData.h"
+#include <stdint.h>
+#include <string.h>
+#include <vector>
+
+/***********************************************************************************************************************
+ * C L A S S E S
+ **********************************************************************************************************************/
+class LocStorage
+{
+public:
+    LocStorage() : m_AcOption(0), m_EmergencyOption(0), m_XpNetAddress(0) {}
+
+    uint8_t AcOptionGet(void) { return (m_AcOption); }
+    void AcOptionSet(uint8_t Value) { m_AcOption = Value; }
+    uint8_t EmergencyOptionGet(void) { return (m_EmergencyOption); }
+    void EmergencyOptionSet(uint8_t Value) { m_EmergencyOption = Value; }
+    uint8_t XpNetAddressGet(void) { return (m_XpNetAddress); }
+    void XpNetAddressSet(uint8_t Value) { m_XpNetAddress = Value; }
+    void InvalidateAdc(void) {}
+
+private:
+    uint8_t m_AcOption;
+    uint8_t m_EmergencyOption;
+    uint8_t m_XpNetAddress;
+};
+
+class LocLib
+{
+public:
+    enum store
+    {
+        storeAdd = 0,
+        storeChange,
+        storeAddNoAutoSelect
+    };
+
+    bool StoreLoc(uint16_t Address, uint8_t* FunctionsPtr, char* NamePtr, store Store);
+    bool RemoveLoc(uint16_t Address);
+    uint8_t CheckLoc(uint16_t Address);
+    void LocBubbleSort(void);
+    void InitialLocStore(void);
+    void FunctionAssignedGetStored(uint16_t Address, uint8_t* FunctionsPtr);
+    uint8_t GetNumberOfLocs(void) { return ((uint8_t)(m_Locs.size())); }
+    LocLibData* LocGetAllDataByIndex(uint8_t Index) { return (&m_Locs[Index]); }
+
+    /* Number of loc records read from or written to the storage, shared by the copies the cli makes. */
+    static uint32_t m_StorageReads;
+    static uint32_t m_StorageWrites;
+
+private:
+    /* The loc table stands for the storage, it survives a new cli like the EEPROM. */
+    static std::vector<LocLibData> m_Locs;
+};
+
+#endif
@@ -0,0 +1,19 @@
+/***********************************************************************************************************************
+   @file  LoclibData.h
+   @brief Host replacement of the loc lib data record.
+ **********************************************************************************************************************/
+
+#ifndef LOCLIB_DATA_H
+#define LOCLIB_DATA_H
+
+#include <stdint.h>
+
+typedef struct
+{
+    uint16_t Addres;
+    uint8_t Steps;
+    uint8_t FunctionAssignment[5];
+    char Name[11];
+} LocLibData;
+
+#endif
@@ -0,0 +1,16 @@
+/***********************************************************************************************************************
+   @file  app_cfg.h
+   @brief Host configuration, the tests build the ESP8266 variant unless APP_CFG_UC is set.
+ **********************************************************************************************************************/
+
+#ifndef APP_CFG_H
+#define APP_CFG_H
+
+#define APP_CFG_UC_ESP8266 0
+#define APP_CFG_UC_STM32 1
+
+#ifndef APP_CFG_UC
+#define APP_CFG_UC APP_CFG_UC_ESP8266
+#endif
+
+#endif
@@ -0,0 +1,25 @@
+/***********************************************************************************************************************
+   @file  eep_cfg.h
+   @brief Host replacement of the EEPROM layout of the app, all regions are located below the cli EEPROM area.
+ **********************************************************************************************************************/
+
+#ifndef EEP_CFG_H
+#define EEP_CFG_H
+
+class EepCfg
+{
+public:
+    static const int AcTypeControlAddress        = 1;
+    static const int EmergencyStopEnabledAddress = 2;
+    static const int SsidNameAddress             = 100;
+    static const int SsidPasswordAddress         = 140;
+    static const int EepIpAddressZ21             = 210;
+    static const int EepIpAddressWmc             = 214;
+    static const int EepIpGateway                = 218;
+    static const int EepIpSubnet                 = 222;
+    static const int StaticIpAddress             = 226;
+    static const int ButtonAdcValuesAddressValid = 230;
+    static const int ButtonAdcValuesAddress      = 231;
+};
+
+#endif
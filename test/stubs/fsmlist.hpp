@@ -0,0 +1,13 @@
+/***********************************************************************************************************************
+   @file  fsmlist.hpp
+   @brief Host replacement of the state machine list, events are dropped.
+ **********************************************************************************************************************/
+
+#ifndef FSMLIST_HPP
+#define FSMLIST_HPP
+
+template <class E> void send_event(E const&)
+{
+}
+
+#endif
@@ -0,0 +1,13 @@
+/***********************************************************************************************************************
+   @file  wmc_event.h
+   @brief Host replacement of the events of the app.
+ **********************************************************************************************************************/
+
+#ifndef WMC_EVENT_H
+#define WMC_EVENT_H
+
+struct cliEnterEvent
+{
+};
+
+#endif
@@ -0,0 +1,13 @@
+/***********************************************************************************************************************
+   @file  xmc_event.h
+   @brief Host replacement of the events of the app.
+ **********************************************************************************************************************/
+
+#ifndef XMC_EVENT_H
+#define XMC_EVENT_H
+
+struct cliEnterEvent
+{
+};
+
+#endif